@@ -0,0 +1,146 @@
+﻿#ifndef LIST_PARALLEL_SORT
+#define LIST_PARALLEL_SORT
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "sort.cpp"
+
+struct ParallelSortOptions {
+    // Upper bound on worker threads; 0 means hardware_concurrency().
+    size_t threads = 0;
+    // Minimum nodes per chunk; lists shorter than two grains sort serially.
+    size_t grain = size_t{1} << 16;
+    // Node count if the caller already knows it, saving a counting walk.
+    size_t length = 0;
+};
+
+// Co-rank of output position k in the stable merge of a[0, na) and
+// b[0, nb): how many of the first k merged nodes come from a. Ties are
+// taken from a, so a[i] goes first unless b's node is strictly smaller.
+template<typename Node, typename Compare>
+size_t merge_co_rank(size_t k, Node *const *a, size_t na, Node *const *b, size_t nb, Compare &comp) {
+    size_t lo = k > nb ? k - nb : 0;
+    size_t hi = std::min(k, na);
+    while (lo < hi) {
+        size_t i = lo + (hi - lo) / 2;
+        if (comp(node_value(b[k - i - 1]), node_value(a[i]))) hi = i;
+        else lo = i + 1;
+    }
+    return lo;
+}
+
+// Merges one slice [k0, k1) of the stable merge of a and b into out.
+template<typename Node, typename Compare>
+void merge_index_slice(Node *const *a, size_t na, Node *const *b, size_t nb, Node **out,
+                       size_t k0, size_t k1, Compare &comp) {
+    size_t i = merge_co_rank(k0, a, na, b, nb, comp);
+    size_t j = k0 - i;
+    const size_t i1 = merge_co_rank(k1, a, na, b, nb, comp);
+    const size_t j1 = k1 - i1;
+    Node **dst = out + k0;
+    while (i < i1 && j < j1) {
+        *dst++ = comp(node_value(b[j]), node_value(a[i])) ? b[j++] : a[i++];
+    }
+    dst = std::copy(a + i, a + i1, dst);
+    std::copy(b + j, b + j1, dst);
+}
+
+// Cuts the chain into up to `threads` pieces of at least `grain` nodes in
+// one walk and sorts the pieces concurrently, each recording its sorted
+// order in an array of node pointers. The runs are then merged pairwise in
+// rounds on those arrays; every merge is split by co-rank into slices of
+// about n / threads nodes, so all threads stay busy up to and including the
+// final merge. A last parallel pass rewrites next (and prev) links from the
+// merged order. Costs two arrays of n pointers. Optionally reports the new
+// tail.
+template<typename Node, typename Compare = std::less<> >
+auto parallel_merge_sort(Node *head, Compare comp = {}, ParallelSortOptions options = {},
+                         Node **tail = nullptr)
+    -> std::enable_if_t<is_singly_v<Node> || is_doubly_v<Node>, Node *> {
+    size_t n = options.length;
+    if (n == 0) {
+        for (Node *curr = head; curr; curr = curr->next) ++n;
+    }
+
+    size_t threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    size_t chunks = std::min(threads, n / std::max<size_t>(options.grain, 1));
+
+    if (chunks < 2) return merge_sort(head, comp, tail);
+
+    // Runs as [offset, offset + length) ranges of the index arrays.
+    std::vector<size_t> offsets(chunks + 1);
+    std::vector<Node *> heads(chunks);
+    Node *curr = head;
+    for (size_t i = 0; i < chunks; ++i) {
+        size_t len = n / chunks + (i < n % chunks ? 1 : 0);
+        offsets[i + 1] = offsets[i] + len;
+        heads[i] = curr;
+        for (size_t j = 1; j < len; ++j) curr = curr->next;
+        Node *next = curr->next;
+        curr->next = nullptr;
+        curr = next;
+    }
+
+    std::vector<Node *> index(n);
+    std::vector<Node *> merged(n);
+    {
+        std::vector<std::jthread> workers;
+        for (size_t i = 0; i < chunks; ++i) {
+            workers.emplace_back([&, i, comp]() mutable {
+                Node **dst = index.data() + offsets[i];
+                for (Node *node = sort_runs(heads[i], comp); node; node = node->next) *dst++ = node;
+            });
+        }
+    }
+
+    while (offsets.size() > 2) {
+        const size_t runs = offsets.size() - 1;
+        std::vector<size_t> next_offsets;
+        {
+            std::vector<std::jthread> workers;
+            for (size_t r = 0; r < runs; r += 2) {
+                next_offsets.push_back(offsets[r]);
+                Node *const *a = index.data() + offsets[r];
+                Node **out = merged.data() + offsets[r];
+                if (r + 1 == runs) {
+                    workers.emplace_back([a, out, len = offsets[r + 1] - offsets[r]] {
+                        std::copy(a, a + len, out);
+                    });
+                    continue;
+                }
+                const size_t na = offsets[r + 1] - offsets[r];
+                const size_t nb = offsets[r + 2] - offsets[r + 1];
+                const size_t total = na + nb;
+                const size_t slices = std::max<size_t>(1, threads * total / n);
+                for (size_t s = 0; s < slices; ++s) {
+                    workers.emplace_back([=]() mutable {
+                        merge_index_slice(a, na, a + na, nb, out, total * s / slices, total * (s + 1) / slices,
+                                          comp);
+                    });
+                }
+            }
+        }
+        next_offsets.push_back(n);
+        offsets.swap(next_offsets);
+        index.swap(merged);
+    }
+
+    {
+        std::vector<std::jthread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                for (size_t k = n * t / threads; k < n * (t + 1) / threads; ++k) {
+                    index[k]->next = k + 1 < n ? index[k + 1] : nullptr;
+                    if constexpr (is_doubly_v<Node>) index[k]->prev = k ? index[k - 1] : nullptr;
+                }
+            });
+        }
+    }
+
+    if (tail) *tail = index[n - 1];
+    return index[0];
+}
+
+#endif // LIST_PARALLEL_SORT
@@ -0,0 +1,87 @@
+﻿#ifndef LIST_PREFETCH_H
+#define LIST_PREFETCH_H
+#include <cstddef>
+
+#if !defined(__GNUC__) && !defined(__clang__) && (defined(__SSE__) || defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+// Prefetch policies for the list templates' Prefetch parameter.
+//
+// A linked list walk cannot prefetch ahead on its own: the address of the
+// node k steps away is only known after the k - 1 nodes before it have
+// been loaded. PrefetchAhead<K> gives every node a jump pointer (Luk &
+// Mowry, 1996) to the node K steps further on. Jump pointers are hints:
+// full traversals (contains, remove) refresh them as they go and prefetch
+// through them, clear() only prefetches. A stale hint costs a useless
+// prefetch and nothing else, because prefetches never fault and hints are
+// never dereferenced. NoPrefetch, the default, adds no field and no
+// instructions.
+//
+// sort() ignores the policy: merging relinks the nodes into an order the
+// jump pointers know nothing about.
+struct NoPrefetch {
+    static constexpr size_t distance = 0;
+};
+
+template<size_t Distance = 8>
+struct PrefetchAhead {
+    static_assert(Distance >= 2 && (Distance & (Distance - 1)) == 0, "distance must be a power of two >= 2");
+    static constexpr size_t distance = Distance;
+};
+
+template<typename Prefetch>
+inline constexpr bool prefetch_enabled_v = Prefetch::distance != 0;
+
+// A read prefetch into all cache levels, or nothing where no prefetch
+// instruction is available.
+inline void prefetch_read(const void *p) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(p, 0, 3);
+#elif defined(__SSE__) || defined(_M_X64) || defined(_M_IX86)
+    _mm_prefetch(static_cast<const char *>(p), _MM_HINT_T0);
+#else
+    (void) p;
+#endif
+}
+
+// Storage for the jump pointer; empty under NoPrefetch so that
+// [[no_unique_address]] removes it from the node.
+template<typename Node, bool Enabled>
+struct JumpLink {
+    mutable Node *jump = nullptr;
+};
+
+template<typename Node>
+struct JumpLink<Node, false> {
+};
+
+// Remembers the last Distance nodes of a traversal. visit() points the
+// node Distance steps back at the current one and prefetches the current
+// node's own jump target.
+template<typename Node, typename Prefetch>
+class JumpWindow {
+    static constexpr size_t size = Prefetch::distance ? Prefetch::distance : 1;
+
+    Node *ring[size] = {};
+    size_t pos = 0;
+
+public:
+    void visit(Node *node) {
+        if constexpr (prefetch_enabled_v<Prefetch>) {
+            if (Node *back = ring[pos]; back && back->link.jump != node) back->link.jump = node;
+            ring[pos] = node;
+            pos = (pos + 1) & (size - 1);
+            if (node->link.jump) prefetch_read(node->link.jump);
+        }
+    }
+
+    // Prefetch only, for walks that free or relink the nodes they pass.
+    static void follow(Node *node) {
+        if constexpr (prefetch_enabled_v<Prefetch>) {
+            if (node->link.jump) prefetch_read(node->link.jump);
+        }
+    }
+};
+
+#endif //LIST_PREFETCH_H
@@ -0,0 +1,145 @@
+﻿#ifndef LIST_RADIX_SORT
+#define LIST_RADIX_SORT
+#include <climits>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include "traits.h"
+
+template<typename Node, typename Key>
+using radix_key_t = std::remove_cvref_t<std::invoke_result_t<Key &, decltype(node_value(std::declval<Node *>()))> >;
+
+// Maps a key to an unsigned integer with the same order: the sign bit of
+// signed types is flipped so that negative keys come first.
+template<typename K>
+auto radix_bits(K key) {
+    if constexpr (std::is_enum_v<K>) {
+        return radix_bits(static_cast<std::underlying_type_t<K> >(key));
+    } else {
+        using U = std::make_unsigned_t<K>;
+        U bits = static_cast<U>(key);
+        if constexpr (std::is_signed_v<K>) bits ^= U{1} << (sizeof(U) * CHAR_BIT - 1);
+        return bits;
+    }
+}
+
+// LSD radix sort over `next` links: each pass deals the nodes into 256
+// bucket chains by one byte of the key and splices the buckets back in
+// order. Nodes are relinked, never copied, and the bucket tables (up to
+// 50 KB) live on the stack. Stable, like merge_sort.
+//
+// Past the first pass the nodes are in no useful memory order, so one walk
+// would stall on a cache miss per node. The spliced list is instead cut at
+// bucket boundaries into radix_lanes segments that the next pass walks in
+// lockstep, with buckets per lane spliced lane by lane to stay stable. The
+// first pass also notes which key bytes vary; the others are skipped, so
+// 16-bit keys in an int take two passes. Doubly nodes get their prev links
+// while being dealt, and `tail` receives the last node.
+inline constexpr size_t radix_lanes = 8;
+
+template<typename Node, typename Key>
+Node *radix_sort_runs(Node *head, Key &key, Node **tail = nullptr) {
+    if (!head || !head->next) {
+        if (tail) *tail = head;
+        return head;
+    }
+
+    auto bits = [&key](Node *node) { return radix_bits(std::invoke(key, node_value(node))); };
+    using Bits = decltype(bits(head));
+    const Bits first = bits(head);
+    Bits differ = 0;
+    size_t total = 0;
+
+    Node *heads[radix_lanes][256];
+    Node **links[radix_lanes][256];
+    Node *lasts[is_doubly_v<Node> ? radix_lanes : 1][256];
+    size_t counts[256];
+    Node *segments[radix_lanes] = {head};
+    size_t lanes = 1;
+
+    for (size_t shift = 0; shift < sizeof(Bits) * CHAR_BIT; shift += 8) {
+        if (shift && !((differ >> shift) & 0xFF)) continue;
+
+        for (size_t k = 0; k < lanes; ++k) {
+            for (size_t b = 0; b < 256; ++b) links[k][b] = &heads[k][b];
+            if constexpr (is_doubly_v<Node>) {
+                for (size_t b = 0; b < 256; ++b) lasts[k][b] = nullptr;
+            }
+        }
+        for (size_t &c: counts) c = 0;
+
+        for (bool any = true; any;) {
+            any = false;
+            for (size_t k = 0; k < lanes; ++k) {
+                Node *node = segments[k];
+                if (!node) continue;
+                any = true;
+                segments[k] = node->next;
+                const Bits value = bits(node);
+                if (!shift) differ |= value ^ first;
+                const size_t b = (value >> shift) & 0xFF;
+                *links[k][b] = node;
+                links[k][b] = &node->next;
+                if constexpr (is_doubly_v<Node>) {
+                    node->prev = lasts[k][b];
+                    lasts[k][b] = node;
+                }
+                ++counts[b];
+            }
+        }
+        if (!shift) {
+            for (size_t c: counts) total += c;
+        }
+
+        // Splice the buckets in order; unless this was the last pass, cut a
+        // new segment whenever the current one has its share of nodes.
+        const bool last = !(differ >> shift >> 8);
+        const size_t share = last ? total : (total + radix_lanes - 1) / radix_lanes;
+        const size_t filled_lanes = lanes;
+        Node **link = &segments[0];
+        Node *prev = nullptr;
+        size_t taken = 0;
+        lanes = 1;
+        for (size_t b = 0; b < 256; ++b) {
+            if (!counts[b]) continue;
+            if (taken >= share && lanes < radix_lanes) {
+                *link = nullptr;
+                link = &segments[lanes++];
+                prev = nullptr;
+                taken = 0;
+            }
+            for (size_t k = 0; k < filled_lanes; ++k) {
+                if (links[k][b] == &heads[k][b]) continue;
+                *link = heads[k][b];
+                link = links[k][b];
+                if constexpr (is_doubly_v<Node>) {
+                    heads[k][b]->prev = prev;
+                    prev = lasts[k][b];
+                }
+            }
+            taken += counts[b];
+        }
+        *link = nullptr;
+        if (last) {
+            if (tail) *tail = prev;
+            break;
+        }
+    }
+    return segments[0];
+}
+
+// Sorts by key(value), which must yield an integer or enum; the default
+// sorts integer elements by themselves. Member pointers work as keys.
+template<typename Node, typename Key = std::identity>
+auto radix_sort(Node *head, Key key = {})
+    -> std::enable_if_t<is_singly_v<Node> && is_radix_key_v<radix_key_t<Node, Key> >, Node *> {
+    return radix_sort_runs(head, key);
+}
+
+template<typename Node, typename Key = std::identity>
+auto radix_sort(Node *head, Key key = {}, Node **tail = nullptr)
+    -> std::enable_if_t<is_doubly_v<Node> && is_radix_key_v<radix_key_t<Node, Key> >, Node *> {
+    return radix_sort_runs(head, key, tail);
+}
+
+#endif // LIST_RADIX_SORT
@@ -0,0 +1,107 @@
+﻿#ifndef LIST_SEARCH_H
+#define LIST_SEARCH_H
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include "traits.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Bytes compared per instruction; 0 when only the scalar loop is available.
+#if defined(__AVX2__)
+inline constexpr size_t simd_width = 32;
+#elif defined(__SSE2__)
+inline constexpr size_t simd_width = 16;
+#else
+inline constexpr size_t simd_width = 0;
+#endif
+
+// Byte mask of the lanes in p[0, simd_width / sizeof(T)) equal to value.
+// Every byte of a matching lane is set, so a lane index is bit / sizeof(T).
+template<typename T>
+unsigned simd_match(const T *p, T value) {
+#if defined(__AVX2__)
+    if constexpr (std::is_same_v<T, float>) {
+        __m256 eq = _mm256_cmp_ps(_mm256_loadu_ps(p), _mm256_set1_ps(value), _CMP_EQ_OQ);
+        return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_castps_si256(eq)));
+    } else if constexpr (std::is_same_v<T, double>) {
+        __m256d eq = _mm256_cmp_pd(_mm256_loadu_pd(p), _mm256_set1_pd(value), _CMP_EQ_OQ);
+        return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_castpd_si256(eq)));
+    } else {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i eq;
+        if constexpr (sizeof(T) == 1) eq = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(static_cast<char>(value)));
+        else if constexpr (sizeof(T) == 2) eq = _mm256_cmpeq_epi16(v, _mm256_set1_epi16(static_cast<short>(value)));
+        else if constexpr (sizeof(T) == 4) eq = _mm256_cmpeq_epi32(v, _mm256_set1_epi32(static_cast<int>(value)));
+        else eq = _mm256_cmpeq_epi64(v, _mm256_set1_epi64x(static_cast<long long>(value)));
+        return static_cast<unsigned>(_mm256_movemask_epi8(eq));
+    }
+#elif defined(__SSE2__)
+    if constexpr (std::is_same_v<T, float>) {
+        __m128 eq = _mm_cmpeq_ps(_mm_loadu_ps(p), _mm_set1_ps(value));
+        return static_cast<unsigned>(_mm_movemask_epi8(_mm_castps_si128(eq)));
+    } else if constexpr (std::is_same_v<T, double>) {
+        __m128d eq = _mm_cmpeq_pd(_mm_loadu_pd(p), _mm_set1_pd(value));
+        return static_cast<unsigned>(_mm_movemask_epi8(_mm_castpd_si128(eq)));
+    } else {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        if constexpr (sizeof(T) == 1) {
+            return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(static_cast<char>(value)))));
+        } else if constexpr (sizeof(T) == 2) {
+            return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi16(v, _mm_set1_epi16(static_cast<short>(value)))));
+        } else if constexpr (sizeof(T) == 4) {
+            return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi32(v, _mm_set1_epi32(static_cast<int>(value)))));
+        } else {
+            // SSE2 has no 64-bit compare: a lane matches when both halves do.
+            auto halves = static_cast<unsigned>(_mm_movemask_epi8(
+                _mm_cmpeq_epi32(v, _mm_set1_epi64x(static_cast<long long>(value)))));
+            return ((halves & 0x00FFu) == 0x00FFu ? 0x00FFu : 0u) |
+                   ((halves & 0xFF00u) == 0xFF00u ? 0xFF00u : 0u);
+        }
+    }
+#else
+    (void) p;
+    (void) value;
+    return 0;
+#endif
+}
+
+// Index of the first element of data[0, n) equal to value, or n.
+template<typename T>
+size_t simd_find(const T *data, size_t n, const T &value) {
+    size_t i = 0;
+    if constexpr (simd_width != 0 && is_simd_searchable_v<T>) {
+        constexpr size_t lanes = simd_width / sizeof(T);
+        for (; i + lanes <= n; i += lanes) {
+            unsigned mask = simd_match(data + i, value);
+            if (mask) return i + static_cast<size_t>(std::countr_zero(mask)) / sizeof(T);
+        }
+    }
+    for (; i < n; ++i) {
+        if (data[i] == value) return i;
+    }
+    return n;
+}
+
+// Number of elements of data[0, n) equal to value.
+template<typename T>
+size_t simd_count(const T *data, size_t n, const T &value) {
+    size_t i = 0;
+    size_t found = 0;
+    if constexpr (simd_width != 0 && is_simd_searchable_v<T>) {
+        constexpr size_t lanes = simd_width / sizeof(T);
+        for (; i + lanes <= n; i += lanes) {
+            found += static_cast<size_t>(std::popcount(simd_match(data + i, value))) / sizeof(T);
+        }
+    }
+    for (; i < n; ++i) {
+        if (data[i] == value) ++found;
+    }
+    return found;
+}
+
+#endif //LIST_SEARCH_H
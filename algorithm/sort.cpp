@@ -1,79 +1,169 @@
 ﻿#ifndef LIST_SORT
 #define LIST_SORT
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include "traits.h"
 
+// The link merge_runs and sort_runs follow. XOR nodes have none; they lend
+// their npx field, which holds a plain next pointer while they are sorted.
 template<typename Node>
-auto merge_sorted(Node *a, Node *b)
-    -> std::enable_if_t<is_singly_v<Node>, Node *> {
-    Node dummy{{}};
-    Node *tail = &dummy;
+Node *&next_link(Node *node) {
+    if constexpr (is_xor_v<Node>) return node->npx;
+    else return node->next;
+}
+
+// Stable merge of two null-terminated runs that only rewires `next`; ties
+// are taken from `a`. Sets `a_left` when a's tail ends the merged run.
+template<typename Node, typename Compare>
+Node *merge_runs(Node *a, Node *b, Compare &comp, bool *a_left = nullptr) {
+    Node *result = nullptr;
+    Node **link = &result;
 
     while (a && b) {
-        if (a->data <= b->data) {
-            tail->next = a;
-            a = a->next;
+        if (comp(node_value(b), node_value(a))) {
+            *link = b;
+            b = next_link(b);
         } else {
-            tail->next = b;
-            b = b->next;
+            *link = a;
+            a = next_link(a);
         }
-        tail = tail->next;
+        link = &next_link(*link);
     }
-    tail->next = a ? a : b;
-    return dummy.next;
+    *link = a ? a : b;
+    if (a_left) *a_left = a != nullptr;
+    return result;
 }
 
-template<typename Node>
-auto merge_sorted(Node *a, Node *b)
-    -> std::enable_if_t<is_doubly_v<Node>, Node *> {
-    Node dummy{{}};
-    Node *tail = &dummy;
+// Bottom-up merge sort over `next` links, same scheme as std::list::sort:
+// bins[i] holds a sorted run of 2^i nodes, and each new node is carried up
+// through the occupied bins. No recursion, no middle-finding walks. Each
+// bin's tail is tracked alongside it, so the last node can be reported
+// without walking the result.
+template<typename Node, typename Compare>
+Node *sort_runs(Node *head, Compare &comp, Node **tail = nullptr) {
+    if (!head || !next_link(head)) {
+        if (tail) *tail = head;
+        return head;
+    }
 
-    while (a && b) {
-        if (a->data <= b->data) {
-            tail->next = a;
-            a->prev = tail;
-            a = a->next;
+    Node *bins[64] = {};
+    Node *tails[64] = {};
+    size_t fill = 0;
+    bool a_left = false;
+
+    while (head) {
+        Node *carry = head;
+        Node *carry_tail = head;
+        head = next_link(head);
+        next_link(carry) = nullptr;
+
+        size_t i = 0;
+        for (; i < fill && bins[i]; ++i) {
+            carry = merge_runs(bins[i], carry, comp, &a_left);
+            if (a_left) carry_tail = tails[i];
+            bins[i] = nullptr;
+        }
+        bins[i] = carry;
+        tails[i] = carry_tail;
+        if (i == fill) ++fill;
+    }
+
+    Node *result = nullptr;
+    Node *result_tail = nullptr;
+    for (size_t i = 0; i < fill; ++i) {
+        if (!bins[i]) continue;
+        if (result) {
+            result = merge_runs(bins[i], result, comp, &a_left);
+            if (a_left) result_tail = tails[i];
         } else {
-            tail->next = b;
-            b->prev = tail;
-            b = b->next;
+            result = bins[i];
+            result_tail = tails[i];
         }
-        tail = tail->next;
+    }
+    if (tail) *tail = result_tail;
+    return result;
+}
+
+template<typename Node, typename Compare = std::less<> >
+auto merge_sorted(Node *a, Node *b, Compare comp = {})
+    -> std::enable_if_t<is_singly_v<Node>, Node *> {
+    return merge_runs(a, b, comp);
+}
+
+template<typename Node, typename Compare = std::less<> >
+auto merge_sorted(Node *a, Node *b, Compare comp = {})
+    -> std::enable_if_t<is_doubly_v<Node>, Node *> {
+    Node *result = nullptr;
+    Node **link = &result;
+    Node *tail = nullptr;
+
+    while (a && b) {
+        Node *&src = comp(node_value(b), node_value(a)) ? b : a;
+        *link = src;
+        src->prev = tail;
+        tail = src;
+        src = src->next;
+        link = &tail->next;
     }
 
     Node *rest = a ? a : b;
-    tail->next = rest;
+    *link = rest;
     if (rest) rest->prev = tail;
-
-    Node *result = dummy.next;
-    if (result) result->prev = nullptr;
     return result;
 }
 
-template<typename Node>
-auto merge_sort(Node *head)
+template<typename Node, typename Compare = std::less<> >
+auto merge_sort(Node *head, Compare comp = {}, Node **tail = nullptr)
     -> std::enable_if_t<is_singly_v<Node>, Node *> {
-    if (!head || !head->next) return head;
+    return sort_runs(head, comp, tail);
+}
 
-    Node *mid = get_middle(head);
-    Node *right = mid->next;
-    mid->next = nullptr;
+// prev links are ignored while merging and rebuilt in one final pass,
+// which also finds the last node for callers that pass `tail`.
+template<typename Node, typename Compare = std::less<> >
+auto merge_sort(Node *head, Compare comp = {}, Node **tail = nullptr)
+    -> std::enable_if_t<is_doubly_v<Node>, Node *> {
+    head = sort_runs(head, comp);
 
-    return merge_sorted(merge_sort(head), merge_sort(right));
+    Node *prev = nullptr;
+    for (Node *curr = head; curr; prev = curr, curr = curr->next) {
+        curr->prev = prev;
+    }
+    if (tail) *tail = prev;
+    return head;
 }
 
 template<typename Node>
-auto merge_sort(Node *head)
-    -> std::enable_if_t<is_doubly_v<Node>, Node *> {
-    if (!head || !head->next) return head;
+Node *xor_of(Node *a, Node *b) {
+    return reinterpret_cast<Node *>(reinterpret_cast<uintptr_t>(a) ^ reinterpret_cast<uintptr_t>(b));
+}
 
-    Node *mid = get_middle(head);
-    Node *right = mid->next;
+// In place and without allocating: one pass decodes npx into plain next
+// pointers, the chain is sorted like a singly linked one, and a last pass
+// encodes npx again from the new neighbours.
+template<typename Node, typename Compare = std::less<> >
+auto merge_sort(Node *head, Compare comp = {}, Node **tail = nullptr)
+    -> std::enable_if_t<is_xor_v<Node>, Node *> {
+    Node *prev = nullptr;
+    for (Node *curr = head; curr;) {
+        Node *next = xor_of(prev, curr->npx);
+        curr->npx = next;
+        prev = curr;
+        curr = next;
+    }
 
-    mid->next = nullptr;
-    if (right) right->prev = nullptr;
+    head = sort_runs(head, comp);
 
-    return merge_sorted(merge_sort(head), merge_sort(right));
+    prev = nullptr;
+    for (Node *curr = head; curr;) {
+        Node *next = curr->npx;
+        curr->npx = xor_of(prev, next);
+        prev = curr;
+        curr = next;
+    }
+    if (tail) *tail = prev;
+    return head;
 }
 
 #endif // LIST_SORT
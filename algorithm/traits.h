@@ -29,6 +29,19 @@ struct has_npx<T, std::void_t<decltype(std::declval<T>().npx)> >
         : std::true_type {
 };
 
+template<typename A, typename = void>
+struct has_release : std::false_type {
+};
+
+template<typename A>
+struct has_release<A, std::void_t<decltype(std::declval<A &>().release()),
+            decltype(std::declval<const A &>().live())> >
+        : std::true_type {
+};
+
+template<typename A>
+inline constexpr bool has_release_v = has_release<A>::value;
+
 template<typename T>
 inline constexpr bool is_singly_v =
         has_next<T>::value && !has_prev<T>::value && !has_npx<T>::value;
@@ -41,6 +54,31 @@ template<typename T>
 inline constexpr bool is_xor_v =
         has_npx<T>::value && !has_next<T>::value;
 
+// Element types the vector search kernels in search.h can compare lane-wise.
+template<typename T>
+inline constexpr bool is_simd_searchable_v =
+        std::is_arithmetic_v<T> && !std::is_same_v<T, bool> &&
+        (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+// Keys radix_sort in radix_sort.cpp can distribute a byte at a time.
+template<typename K>
+inline constexpr bool is_radix_key_v =
+        (std::is_integral_v<K> && !std::is_same_v<K, bool>) || std::is_enum_v<K>;
+
+// Base of the intrusive hooks below; objects deriving from it are their own
+// nodes, so algorithms compare the object itself rather than `data`.
+struct intrusive_hook_tag {
+};
+
+template<typename T>
+inline constexpr bool is_intrusive_v = std::is_base_of_v<intrusive_hook_tag, T>;
+
+template<typename Node>
+decltype(auto) node_value(Node *node) {
+    if constexpr (is_intrusive_v<Node>) return (*node);
+    else return (node->data);
+}
+
 template<typename T>
 struct SinglyNode {
     T data;
@@ -69,4 +107,32 @@ struct XORNode {
     }
 };
 
+// Embedded by user types (struct Timer : IntrusiveSinglyHook<Timer>) so the
+// intrusive lists can link them without allocating. Copying an object does
+// not copy its links.
+template<typename T>
+struct IntrusiveSinglyHook : intrusive_hook_tag {
+    T *next = nullptr;
+
+    IntrusiveSinglyHook() = default;
+
+    IntrusiveSinglyHook(const IntrusiveSinglyHook &) {
+    }
+
+    IntrusiveSinglyHook &operator=(const IntrusiveSinglyHook &) { return *this; }
+};
+
+template<typename T>
+struct IntrusiveDoublyHook : intrusive_hook_tag {
+    T *prev = nullptr;
+    T *next = nullptr;
+
+    IntrusiveDoublyHook() = default;
+
+    IntrusiveDoublyHook(const IntrusiveDoublyHook &) {
+    }
+
+    IntrusiveDoublyHook &operator=(const IntrusiveDoublyHook &) { return *this; }
+};
+
 #endif //TRAITS_H
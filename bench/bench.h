@@ -0,0 +1,152 @@
+﻿#ifndef BENCH_H
+#define BENCH_H
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+// Keeps the optimizer from discarding a value computed inside a benchmark.
+template<typename T>
+inline void do_not_optimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void clobber_memory() {
+    asm volatile("" : : : "memory");
+}
+
+// Calls setup() untimed, then times body(state) on its result. Returns the
+// best of `reps` runs in nanoseconds per element.
+template<typename Setup, typename Body>
+double best_ns_per_element(size_t elements, int reps, Setup setup, Body body) {
+    double best = std::numeric_limits<double>::max();
+    for (int r = 0; r < reps; ++r) {
+        auto state = setup();
+        clobber_memory();
+        auto start = std::chrono::steady_clock::now();
+        body(state);
+        clobber_memory();
+        auto stop = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+        best = std::min(best, ns / static_cast<double>(std::max<size_t>(elements, 1)));
+    }
+    return best;
+}
+
+inline std::vector<int> random_ints(size_t n, uint32_t seed = 42) {
+    std::mt19937 rng(seed);
+    std::vector<int> values(n);
+    for (int &v: values) v = static_cast<int>(rng());
+    return values;
+}
+
+// Sizes come from argv when given, otherwise from `defaults`.
+inline std::vector<size_t> bench_sizes(int argc, char **argv, std::vector<size_t> defaults) {
+    if (argc <= 1) return defaults;
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    return sizes;
+}
+
+inline void print_header(const char *title) {
+    std::printf("%s\n%-40s %12s %12s\n", title, "benchmark", "elements", "ns/elem");
+}
+
+inline void print_row(const std::string &name, size_t elements, double ns) {
+    std::printf("%-40s %12zu %12.2f\n", name.c_str(), elements, ns);
+}
+
+struct ScatterSlab {
+    std::unique_ptr<std::byte[]> slab;
+    std::vector<uint32_t> order;
+    size_t slot_size = 0;
+    size_t next = 0;
+};
+
+// Stands in for a heap after long churn: hands out the single-node slots of
+// one slab, sized on the first allocation, in a random order. Slots are
+// never reused, larger requests go to std::allocator, and the slab goes
+// away with the last copy of the allocator.
+template<typename T>
+class ScatterAllocator {
+    std::shared_ptr<ScatterSlab> state;
+
+    template<typename>
+    friend class ScatterAllocator;
+
+public:
+    using value_type = T;
+
+    explicit ScatterAllocator(size_t slots) : state(std::make_shared<ScatterSlab>()) {
+        state->order.resize(slots);
+        std::iota(state->order.begin(), state->order.end(), 0u);
+        std::shuffle(state->order.begin(), state->order.end(), std::mt19937(99));
+    }
+
+    template<typename U>
+    ScatterAllocator(const ScatterAllocator<U> &other) : state(other.state) {
+    }
+
+    T *allocate(size_t n) {
+        if (n != 1 || state->next == state->order.size()) return std::allocator<T>().allocate(n);
+        if (!state->slab) {
+            state->slot_size = (sizeof(T) + alignof(T) - 1) / alignof(T) * alignof(T);
+            state->slab.reset(new std::byte[state->slot_size * state->order.size()]);
+        }
+        return reinterpret_cast<T *>(state->slab.get() + state->order[state->next++] * state->slot_size);
+    }
+
+    void deallocate(T *p, size_t n) {
+        std::byte *b = reinterpret_cast<std::byte *>(p);
+        std::byte *slab = state->slab.get();
+        if (!slab || b < slab || b >= slab + state->slot_size * state->order.size()) {
+            std::allocator<T>().deallocate(p, n);
+        }
+    }
+
+    bool operator==(const ScatterAllocator &o) const { return state == o.state; }
+};
+
+// A list of n random ints whose nodes sit in random memory order.
+template<typename List>
+List scattered_list(size_t n) {
+    List list{typename List::allocator_type(n)};
+    list.append_range(random_ints(n));
+    return list;
+}
+
+struct BenchResult {
+    std::string container;
+    std::string payload;
+    std::string operation;
+    size_t elements;
+    double ns_per_element;
+};
+
+// Writes results as one JSON document so runs can be diffed over time.
+inline bool write_json(const char *path, const std::vector<BenchResult> &results) {
+    std::FILE *out = std::fopen(path, "w");
+    if (!out) return false;
+    std::fprintf(out, "{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult &r = results[i];
+        std::fprintf(out,
+                     "    {\"name\": \"%s/%s/%s/%zu\", \"container\": \"%s\", \"payload\": \"%s\", "
+                     "\"operation\": \"%s\", \"elements\": %zu, \"ns_per_element\": %.4f}%s\n",
+                     r.container.c_str(), r.payload.c_str(), r.operation.c_str(), r.elements,
+                     r.container.c_str(), r.payload.c_str(), r.operation.c_str(), r.elements,
+                     r.ns_per_element, i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+    return std::fclose(out) == 0;
+}
+
+#endif //BENCH_H
@@ -0,0 +1,45 @@
+﻿#include <ranges>
+#include "bench.h"
+#include "../list/circular_linked_list.h"
+#include "../list/doubly_linked_list.h"
+#include "../list/singly_linked_list.h"
+#include "../list/xor_linked_list.h"
+#include "../memory/node_pool.h"
+
+// Filling a list from existing data: a push_back loop against the range
+// constructor, append_range and from_stream over a lazy view.
+template<typename List>
+void run(const std::string &name, const std::vector<int> &values) {
+    const size_t n = values.size();
+    print_row(name + " push_back loop", n, best_ns_per_element(n, 3, [] { return 0; }, [&](int &) {
+        List list;
+        for (int v: values) list.push_back(v);
+        do_not_optimize(list.size());
+    }));
+    print_row(name + " range constructor", n, best_ns_per_element(n, 3, [] { return 0; }, [&](int &) {
+        List list(values.begin(), values.end());
+        do_not_optimize(list.size());
+    }));
+    print_row(name + " append_range", n, best_ns_per_element(n, 3, [] { return 0; }, [&](int &) {
+        List list;
+        list.append_range(values);
+        do_not_optimize(list.size());
+    }));
+    print_row(name + " from_stream(iota)", n, best_ns_per_element(n, 3, [] { return 0; }, [&](int &) {
+        List list = List::from_stream(std::views::iota(0, static_cast<int>(n)));
+        do_not_optimize(list.size());
+    }));
+}
+
+int main(int argc, char **argv) {
+    print_header("bulk load");
+    for (size_t n: bench_sizes(argc, argv, {10000000})) {
+        std::vector<int> values = random_ints(n);
+        run<SinglyLinkedList<int> >("SinglyLinkedList", values);
+        run<DoublyLinkedList<int> >("DoublyLinkedList", values);
+        run<CircularLinkedList<int> >("CircularLinkedList", values);
+        run<XORLinkedList<int> >("XORLinkedList", values);
+        run<DoublyLinkedList<int, NodePool<int> > >("DoublyLinkedList+NodePool", values);
+    }
+    return 0;
+}
@@ -0,0 +1,46 @@
+﻿#include <unordered_set>
+#include "bench.h"
+#include "../list/circular_linked_list.h"
+#include "../list/doubly_linked_list.h"
+#include "../list/singly_linked_list.h"
+#include "../list/xor_linked_list.h"
+
+// Purging 10% of a list: remove_if() and erase(set) in one pass each,
+// against the old way of one remove() scan per victim. The old way is
+// quadratic, so it only runs on a prefix of `n`.
+template<typename List>
+void run(const std::string &name, size_t n) {
+    const std::vector<int> values = random_ints(n);
+    auto doomed = [](int v) { return v % 10 == 0; };
+    auto build = [&](size_t size) {
+        return [&, size] { return List(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(size)); };
+    };
+
+    print_row(name + " remove_if", n, best_ns_per_element(n, 3, build(n), [&](List &list) {
+        do_not_optimize(list.remove_if(doomed));
+    }));
+
+    std::unordered_set<int> set;
+    for (int v: values) if (doomed(v)) set.insert(v);
+    print_row(name + " erase(unordered_set)", n, best_ns_per_element(n, 3, build(n), [&](List &list) {
+        do_not_optimize(list.erase(set));
+    }));
+
+    const size_t small = std::min<size_t>(n, 20000);
+    std::vector<int> victims;
+    for (size_t i = 0; i < small; ++i) if (doomed(values[i])) victims.push_back(values[i]);
+    print_row(name + " remove() per value", small, best_ns_per_element(small, 3, build(small), [&](List &list) {
+        for (int v: victims) do_not_optimize(list.remove(v));
+    }));
+}
+
+int main(int argc, char **argv) {
+    print_header("bulk removal of 10% of the elements");
+    for (size_t n: bench_sizes(argc, argv, {10000000})) {
+        run<SinglyLinkedList<int> >("SinglyLinkedList", n);
+        run<DoublyLinkedList<int> >("DoublyLinkedList", n);
+        run<CircularLinkedList<int> >("CircularLinkedList", n);
+        run<XORLinkedList<int> >("XORLinkedList", n);
+    }
+    return 0;
+}
@@ -0,0 +1,53 @@
+﻿#include <cstdlib>
+#include <malloc.h>
+#include <new>
+#include "bench.h"
+#include "../list/compact_xor_linked_list.h"
+#include "../list/xor_linked_list.h"
+
+// Pointer XORLinkedList against the index-addressed CompactXORLinkedList:
+// heap bytes per element (as reported by malloc_usable_size, so allocator
+// rounding is included) and traversal/search time.
+static size_t heap_bytes = 0;
+
+void *operator new(size_t size) {
+    if (void *p = std::malloc(size ? size : 1)) {
+        heap_bytes += malloc_usable_size(p);
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    heap_bytes -= malloc_usable_size(p);
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+
+template<typename List>
+void run(const char *name, size_t n) {
+    size_t before = heap_bytes;
+    List list;
+    for (size_t i = 0; i < n; ++i) list.push_back(static_cast<int>(i));
+    std::printf("%-40s %12zu %12.2f bytes/elem\n", name, n,
+                static_cast<double>(heap_bytes - before) / static_cast<double>(n));
+
+    print_row(std::string(name) + " iterate", n, best_ns_per_element(n, 5, [] { return 0; }, [&](int &) {
+        int64_t sum = 0;
+        for (auto it = list.begin(); it != list.end(); ++it) sum += *it;
+        do_not_optimize(sum);
+    }));
+    print_row(std::string(name) + " contains (miss)", n, best_ns_per_element(n, 5, [] { return 0; }, [&](int &) {
+        do_not_optimize(list.contains(-1));
+    }));
+}
+
+int main(int argc, char **argv) {
+    print_header("XORLinkedList vs CompactXORLinkedList");
+    for (size_t n: bench_sizes(argc, argv, {1000, 100000, 10000000})) {
+        run<XORLinkedList<int> >("XORLinkedList<int>", n);
+        run<CompactXORLinkedList<int> >("CompactXORLinkedList<int>", n);
+    }
+    return 0;
+}
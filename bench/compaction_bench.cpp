@@ -0,0 +1,52 @@
+﻿#include "bench.h"
+#include "../list/circular_linked_list.h"
+#include "../list/doubly_linked_list.h"
+#include "../list/singly_linked_list.h"
+#include "../list/xor_linked_list.h"
+
+// Iteration over a freshly built list, the same list with its nodes
+// scattered in random memory order, and that list after compact(), plus
+// the cost of compact() itself.
+template<typename List>
+long long sum(const List &list) {
+    long long total = 0;
+    for (int v: list) total += v;
+    return total;
+}
+
+template<template<typename, typename, typename> class List>
+void run(const std::string &name, size_t n) {
+    using Fresh = List<int, std::allocator<int>, NoPrefetch>;
+    using Scattered = List<int, ScatterAllocator<int>, NoPrefetch>;
+
+    Fresh fresh;
+    fresh.append_range(random_ints(n));
+    print_row(name + " iterate fresh", n, best_ns_per_element(n, 3, [] { return 0; }, [&](int &) {
+        do_not_optimize(sum(fresh));
+    }));
+    fresh.clear();
+
+    Scattered list = scattered_list<Scattered>(n);
+    std::printf("%s fragmentation %.2f\n", name.c_str(), list.fragmentation());
+    print_row(name + " iterate scattered", n, best_ns_per_element(n, 3, [] { return 0; }, [&](int &) {
+        do_not_optimize(sum(list));
+    }));
+    print_row(name + " compact()", n, best_ns_per_element(n, 1, [] { return 0; }, [&](int &) {
+        list.compact();
+    }));
+    std::printf("%s fragmentation %.2f\n", name.c_str(), list.fragmentation());
+    print_row(name + " iterate compacted", n, best_ns_per_element(n, 3, [] { return 0; }, [&](int &) {
+        do_not_optimize(sum(list));
+    }));
+}
+
+int main(int argc, char **argv) {
+    print_header("compaction");
+    for (size_t n: bench_sizes(argc, argv, {1000000, 10000000})) {
+        run<SinglyLinkedList>("SinglyLinkedList", n);
+        run<DoublyLinkedList>("DoublyLinkedList", n);
+        run<CircularLinkedList>("CircularLinkedList", n);
+        run<XORLinkedList>("XORLinkedList", n);
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+﻿#include <atomic>
+#include <mutex>
+#include <thread>
+#include "bench.h"
+#include "../list/concurrent_queue.h"
+#include "../list/singly_linked_list.h"
+
+// The setup the lock-free queue replaces: a SinglyLinkedList behind a mutex.
+template<typename T>
+class LockedQueue {
+    std::mutex mutex;
+    SinglyLinkedList<T> list;
+
+public:
+    void push_back(const T &value) {
+        std::lock_guard lock(mutex);
+        list.push_back(value);
+    }
+
+    std::optional<T> try_pop_front() {
+        std::lock_guard lock(mutex);
+        if (list.empty()) return std::nullopt;
+        return list.pop_front();
+    }
+};
+
+// `threads` producers and as many consumers move `items` values through
+// the queue; the result is wall time per item.
+template<typename Queue>
+double run(size_t threads, size_t items) {
+    return best_ns_per_element(items, 3,
+        [] { return std::make_unique<Queue>(); },
+        [&](std::unique_ptr<Queue> &queue) {
+            std::atomic<size_t> consumed{0};
+            std::atomic<long long> checksum{0};
+            std::vector<std::thread> workers;
+
+            for (size_t t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t] {
+                    for (size_t i = t; i < items; i += threads) queue->push_back(static_cast<int>(i));
+                });
+                workers.emplace_back([&] {
+                    long long sum = 0;
+                    while (consumed.load(std::memory_order_relaxed) < items) {
+                        if (auto value = queue->try_pop_front()) {
+                            sum += *value;
+                            consumed.fetch_add(1, std::memory_order_relaxed);
+                        }
+                    }
+                    checksum.fetch_add(sum);
+                });
+            }
+            for (auto &worker: workers) worker.join();
+
+            long long expected = static_cast<long long>(items) * static_cast<long long>(items - 1) / 2;
+            if (checksum.load() != expected) std::abort();
+        });
+}
+
+int main(int argc, char **argv) {
+    const size_t items = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    print_header("MPMC throughput: ConcurrentQueue vs mutex + SinglyLinkedList (ns per item)");
+
+    for (size_t threads: {1, 2, 4, 8, 16, 32}) {
+        std::string suffix = " x" + std::to_string(threads) + "P/" + std::to_string(threads) + "C";
+        print_row("LockedQueue" + suffix, items, run<LockedQueue<int> >(threads, items));
+        print_row("ConcurrentQueue" + suffix, items, run<ConcurrentQueue<int> >(threads, items));
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+﻿#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include "bench.h"
+#include "../list/circular_linked_list.h"
+#include "../list/doubly_linked_list.h"
+#include "../list/singly_linked_list.h"
+#include "../list/unrolled_linked_list.h"
+#include "../list/xor_linked_list.h"
+
+// Counts every global allocation so the copy/move difference is visible
+// independently of timing noise. All replaceable forms are overridden so that
+// each new is paired with the matching delete; the nothrow forms forward to
+// these by default.
+static size_t allocations = 0;
+
+static void *counted_alloc(size_t size, size_t align = alignof(std::max_align_t)) {
+    ++allocations;
+    size = size ? size : 1;
+    void *p = align <= alignof(std::max_align_t)
+                  ? std::malloc(size)
+                  : std::aligned_alloc(align, (size + align - 1) / align * align);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void *operator new(size_t size) { return counted_alloc(size); }
+
+void *operator new[](size_t size) { return counted_alloc(size); }
+
+void *operator new(size_t size, std::align_val_t align) { return counted_alloc(size, static_cast<size_t>(align)); }
+
+void *operator new[](size_t size, std::align_val_t align) { return counted_alloc(size, static_cast<size_t>(align)); }
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete[](void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+
+void operator delete(void *p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+void operator delete[](void *p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+// Long enough to defeat the small-string buffer.
+static const std::string payload(64, 'x');
+
+template<typename List>
+void run(const char *name, size_t n) {
+    auto report = [&](const char *how, auto fill, auto drain) {
+        size_t before = allocations;
+        double ns = best_ns_per_element(n, 1,
+            [] { return List(); },
+            [&](List &list) {
+                fill(list);
+                drain(list);
+            });
+        std::printf("%-40s %12zu %12.2f %10.2f allocs/elem\n", (std::string(name) + how).c_str(), n, ns,
+                    static_cast<double>(allocations - before) / static_cast<double>(n));
+    };
+
+    // What callers were limited to before: copy in, copy the front out.
+    report(" copy in/out", [&](List &list) {
+        for (size_t i = 0; i < n; ++i) {
+            std::string s = payload;
+            list.push_back(s);
+        }
+    }, [](List &list) {
+        while (!list.empty()) {
+            std::string s = list.front();
+            list.pop_front();
+            do_not_optimize(s);
+        }
+    });
+
+    auto move_out = [](List &list) {
+        while (!list.empty()) do_not_optimize(list.pop_front());
+    };
+    report(" move in/out", [&](List &list) {
+        for (size_t i = 0; i < n; ++i) {
+            std::string s = payload;
+            list.push_back(std::move(s));
+        }
+    }, move_out);
+    report(" emplace in, move out", [&](List &list) {
+        for (size_t i = 0; i < n; ++i) list.emplace_back(64, 'x');
+    }, move_out);
+}
+
+int main(int argc, char **argv) {
+    print_header("std::string payloads: fill then drain with pop_front");
+
+    for (size_t n: bench_sizes(argc, argv, {100000})) {
+        run<SinglyLinkedList<std::string> >("SinglyLinkedList", n);
+        run<DoublyLinkedList<std::string> >("DoublyLinkedList", n);
+        run<CircularLinkedList<std::string> >("CircularLinkedList", n);
+        run<XORLinkedList<std::string> >("XORLinkedList", n);
+        run<UnrolledLinkedList<std::string> >("UnrolledLinkedList", n);
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+﻿#include <algorithm>
+#include <vector>
+#include "bench.h"
+#include "../list/circular_linked_list.h"
+#include "../list/doubly_linked_list.h"
+#include "../list/xor_linked_list.h"
+
+// sort() members against the workaround they replace: move the elements
+// out to a vector, std::stable_sort it and move them back in list order.
+template<typename List>
+void copy_out_sort(List &list) {
+    std::vector<int> buffer;
+    buffer.reserve(list.size());
+    for (int &v: list) buffer.push_back(std::move(v));
+    std::stable_sort(buffer.begin(), buffer.end());
+    size_t i = 0;
+    for (int &v: list) v = std::move(buffer[i++]);
+}
+
+template<typename List>
+void run(const std::string &name, const std::vector<int> &values) {
+    const size_t n = values.size();
+    auto build = [&] { return List(values.begin(), values.end()); };
+    print_row(name + " sort()", n, best_ns_per_element(n, 3, build, [](List &list) {
+        list.sort();
+        if (!std::is_sorted(list.begin(), list.end())) std::abort();
+    }));
+    print_row(name + " copy-out sort", n, best_ns_per_element(n, 3, build, [](List &list) {
+        copy_out_sort(list);
+        if (!std::is_sorted(list.begin(), list.end())) std::abort();
+    }));
+}
+
+int main(int argc, char **argv) {
+    print_header("in-place sort() vs copy-out to a vector");
+    for (size_t n: bench_sizes(argc, argv, {1000, 100000, 1000000})) {
+        std::vector<int> values = random_ints(n);
+        run<XORLinkedList<int> >("XORLinkedList", values);
+        run<CircularLinkedList<int> >("CircularLinkedList", values);
+        run<DoublyLinkedList<int> >("DoublyLinkedList", values);
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+﻿#include <cmath>
+#include <list>
+#include <unordered_map>
+#include "bench.h"
+#include "../list/doubly_linked_list.h"
+#include "../list/lru_cache.h"
+
+// LRU caches replaying a Zipfian key trace (s = 0.99 over 10x the cache
+// capacity). Times are per access; the hit rate is printed once per size
+// since every cache sees the same trace.
+//
+// The DoublyLinkedList baseline is the contains/remove/push_front cache the
+// hash index replaces; it only runs while the linear scans stay bearable.
+
+std::vector<int> zipf_trace(size_t keys, size_t length, double s) {
+    std::vector<double> cdf(keys);
+    double sum = 0;
+    for (size_t i = 0; i < keys; ++i) {
+        sum += 1.0 / std::pow(static_cast<double>(i + 1), s);
+        cdf[i] = sum;
+    }
+
+    // Ranks are scattered over the key space so hot keys are not adjacent.
+    std::vector<int> ids(keys);
+    for (size_t i = 0; i < keys; ++i) ids[i] = static_cast<int>(i);
+    std::shuffle(ids.begin(), ids.end(), std::mt19937(3));
+
+    std::mt19937_64 rng(17);
+    std::uniform_real_distribution<double> dist(0, sum);
+    std::vector<int> trace(length);
+    for (int &key: trace) {
+        size_t rank = std::lower_bound(cdf.begin(), cdf.end(), dist(rng)) - cdf.begin();
+        key = ids[std::min(rank, keys - 1)];
+    }
+    return trace;
+}
+
+struct ListLRU {
+    DoublyLinkedList<int> order;
+    size_t limit;
+
+    bool access(int key) {
+        bool hit = order.remove(key);
+        if (!hit && order.size() == limit) order.pop_back();
+        order.push_front(key);
+        return hit;
+    }
+};
+
+struct StdLRU {
+    std::list<std::pair<int, int> > order;
+    std::unordered_map<int, std::list<std::pair<int, int> >::iterator> index;
+    size_t limit;
+
+    bool access(int key) {
+        auto it = index.find(key);
+        if (it != index.end()) {
+            order.splice(order.begin(), order, it->second);
+            return true;
+        }
+        if (order.size() == limit) {
+            index.erase(order.back().first);
+            order.pop_back();
+        }
+        order.emplace_front(key, key);
+        index.emplace(key, order.begin());
+        return false;
+    }
+};
+
+int main(int argc, char **argv) {
+    constexpr int reps = 3;
+    constexpr size_t accesses = 2000000;
+    print_header("LRU cache on a Zipfian trace");
+
+    for (size_t capacity: bench_sizes(argc, argv, {1000, 100000, 1000000})) {
+        std::vector<int> trace = zipf_trace(capacity * 10, accesses, 0.99);
+
+        LRUCache<int, int> probe(capacity);
+        for (int key: trace) {
+            if (!probe.get(key)) probe.put(key, key);
+        }
+        std::printf("%-40s %12zu %11.1f%%\n", "hit rate", capacity, probe.hit_rate() * 100);
+
+        print_row("LRUCache", capacity, best_ns_per_element(accesses, reps, [&] {
+            return LRUCache<int, int>(capacity);
+        }, [&](auto &cache) {
+            for (int key: trace) {
+                if (!cache.get(key)) cache.put(key, key);
+            }
+        }));
+        print_row("std::list + std::unordered_map", capacity, best_ns_per_element(accesses, reps, [&] {
+            return StdLRU{{}, {}, capacity};
+        }, [&](auto &cache) {
+            for (int key: trace) do_not_optimize(cache.access(key));
+        }));
+        if (capacity <= 1000) {
+            print_row("DoublyLinkedList remove/push_front", capacity, best_ns_per_element(accesses, reps, [&] {
+                return ListLRU{{}, capacity};
+            }, [&](auto &cache) {
+                for (int key: trace) do_not_optimize(cache.access(key));
+            }));
+        }
+    }
+    return 0;
+}
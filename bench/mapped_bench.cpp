@@ -0,0 +1,52 @@
+﻿#include <filesystem>
+#include "bench.h"
+#include "../list/doubly_linked_list.h"
+#include "../list/mapped_list.h"
+
+// Start-up cost of getting a large list back: rebuilding it with push_back
+// against map_list() of an image written by save_list(). map_list() times
+// include the first full traversal, which is where the pages are actually read.
+int main(int argc, char **argv) {
+    const std::string path = (std::filesystem::temp_directory_path() / "linked_lists_mapped_bench.img").string();
+    print_header("DoublyLinkedList rebuild vs save_list()/map_list()");
+
+    for (size_t n: bench_sizes(argc, argv, {1000000, 10000000})) {
+        std::vector<int> values = random_ints(n);
+
+        print_row("rebuild with push_back", n, best_ns_per_element(n, 3, [] { return 0; }, [&](int &) {
+            DoublyLinkedList<int> list;
+            for (int v: values) list.push_back(v);
+            do_not_optimize(list.back());
+        }));
+
+        DoublyLinkedList<int> list;
+        for (int v: values) list.push_back(v);
+        print_row("save_list()", n, best_ns_per_element(n, 3, [] { return 0; }, [&](int &) {
+            save_list(list, path);
+        }));
+
+        print_row("map_list() + first traversal", n, best_ns_per_element(n, 3, [] { return 0; }, [&](int &) {
+            auto mapped = map_list<DoublyLinkedList<int> >(path);
+            int64_t sum = 0;
+            for (int v: mapped) sum += v;
+            do_not_optimize(sum);
+        }));
+
+        auto mapped = map_list<DoublyLinkedList<int> >(path, MapMode::copy_on_write);
+        print_row("mapped traversal (warm)", n, best_ns_per_element(n, 5, [] { return 0; }, [&](int &) {
+            int64_t sum = 0;
+            for (int v: mapped) sum += v;
+            do_not_optimize(sum);
+        }));
+        print_row("mapped push_back (copy-on-write)", n, best_ns_per_element(n, 1, [] { return 0; }, [&](int &) {
+            for (int v: values) mapped.push_back(v);
+        }));
+        print_row("heap list traversal", n, best_ns_per_element(n, 5, [] { return 0; }, [&](int &) {
+            int64_t sum = 0;
+            for (auto it = list.begin(); it != list.end(); ++it) sum += *it;
+            do_not_optimize(sum);
+        }));
+    }
+    std::filesystem::remove(path);
+    return 0;
+}
@@ -0,0 +1,39 @@
+﻿#include <thread>
+#include "bench.h"
+#include "../list/doubly_linked_list.h"
+#include "../memory/monotonic_arena.h"
+
+// Sorts the same shuffled DoublyLinkedList with 1, 2, 4, ... threads up to
+// the core count and reports the speedup over the serial sort() member.
+// Every run builds its list in a fresh arena so earlier runs cannot leave
+// the heap scrambled for later ones.
+int main(int argc, char **argv) {
+    constexpr int reps = 3;
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    print_header("DoublyLinkedList::parallel_sort scaling");
+
+    for (size_t n: bench_sizes(argc, argv, {1000000, 10000000})) {
+        std::vector<int> values = random_ints(n);
+        auto build = [&] {
+            DoublyLinkedList<int, MonotonicArena<int> > list;
+            for (int v: values) list.push_back(v);
+            return list;
+        };
+
+        double serial = best_ns_per_element(n, reps, build, [](auto &list) {
+            list.sort();
+            do_not_optimize(list.front());
+        });
+        print_row("sort()", n, serial);
+
+        for (size_t threads = 1; threads <= cores; threads *= 2) {
+            double ns = best_ns_per_element(n, reps, build, [&](auto &list) {
+                list.parallel_sort(std::less<>{}, ParallelSortOptions{threads, size_t{1} << 14, 0});
+                do_not_optimize(list.front());
+            });
+            print_row("parallel_sort x" + std::to_string(threads), n, ns);
+            std::printf("%-40s %12s %11.2fx\n", "  speedup vs sort()", "", serial / ns);
+        }
+    }
+    return 0;
+}
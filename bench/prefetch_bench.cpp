@@ -0,0 +1,58 @@
+﻿#include "bench.h"
+#include "../list/circular_linked_list.h"
+#include "../list/doubly_linked_list.h"
+#include "../list/singly_linked_list.h"
+#include "../list/xor_linked_list.h"
+
+// contains/remove/clear with and without PrefetchAhead on lists whose
+// nodes are scattered over a large slab in random order, so that every
+// step of a traversal is a cache (and usually TLB) miss.
+//
+// The first contains() of a PrefetchAhead list installs the jump pointers;
+// the "warm" rows run after it. sort() does not use the policy, its rows
+// show what the extra pointer per node costs.
+
+template<typename Policy>
+void run_list(const std::string &name, size_t n) {
+    using Singly = SinglyLinkedList<int, ScatterAllocator<int>, Policy>;
+    using Doubly = DoublyLinkedList<int, ScatterAllocator<int>, Policy>;
+    using Circular = CircularLinkedList<int, ScatterAllocator<int>, Policy>;
+    using XOR = XORLinkedList<int, ScatterAllocator<int>, Policy>;
+
+    auto measure = [&]<typename List>(const std::string &list_name, List *) {
+        List list = scattered_list<List>(n);
+        print_row(list_name + name + " contains (cold)", n, best_ns_per_element(n, 1, [] { return 0; }, [&](int &) {
+            do_not_optimize(list.contains(-1));
+        }));
+        print_row(list_name + name + " contains (warm)", n, best_ns_per_element(n, 3, [] { return 0; }, [&](int &) {
+            do_not_optimize(list.contains(-1));
+        }));
+        print_row(list_name + name + " remove (last)", n, best_ns_per_element(n, 1, [] { return 0; }, [&](int &) {
+            int last = list.back();
+            do_not_optimize(list.remove(last));
+        }));
+        print_row(list_name + name + " clear", n, best_ns_per_element(n, 1, [] { return 0; }, [&](int &) {
+            list.clear();
+        }));
+    };
+    measure("Singly", static_cast<Singly *>(nullptr));
+    measure("Doubly", static_cast<Doubly *>(nullptr));
+    measure("Circular", static_cast<Circular *>(nullptr));
+    measure("XOR", static_cast<XOR *>(nullptr));
+
+    print_row("Doubly" + name + " sort", n, best_ns_per_element(n, 1, [&] { return scattered_list<Doubly>(n); },
+        [](Doubly &list) {
+            list.sort();
+            do_not_optimize(list.front());
+        }));
+}
+
+int main(int argc, char **argv) {
+    print_header("prefetch policies on scattered nodes");
+    for (size_t n: bench_sizes(argc, argv, {10000000})) {
+        run_list<NoPrefetch>("<NoPrefetch>", n);
+        run_list<PrefetchAhead<8> >("<PrefetchAhead<8>>", n);
+        run_list<PrefetchAhead<16> >("<PrefetchAhead<16>>", n);
+    }
+    return 0;
+}
@@ -0,0 +1,71 @@
+﻿#include <vector>
+#include "bench.h"
+#include "../algorithm/radix_sort.cpp"
+#include "../algorithm/sort.cpp"
+
+struct Record {
+    uint64_t id;
+    double weight;
+
+    bool operator<(const Record &other) const { return id < other.id; }
+};
+
+// Nodes in one vector, linked in storage order, as in sort_bench.
+template<typename Node, typename T>
+struct Chain {
+    std::vector<Node> nodes;
+    Node *head = nullptr;
+
+    explicit Chain(const std::vector<T> &values) {
+        nodes.reserve(values.size());
+        for (const T &v: values) nodes.emplace_back(v);
+        for (size_t i = 0; i + 1 < nodes.size(); ++i) {
+            nodes[i].next = &nodes[i + 1];
+            if constexpr (is_doubly_v<Node>) nodes[i + 1].prev = &nodes[i];
+        }
+        if (!nodes.empty()) head = &nodes[0];
+    }
+};
+
+template<typename Node>
+void check_sorted(const Node *head) {
+    for (; head && head->next; head = head->next) {
+        if (head->next->data < head->data) std::abort();
+    }
+}
+
+template<typename Node, typename T, typename Key>
+void run(const std::string &name, const std::vector<T> &values, Key key) {
+    const size_t n = values.size();
+    const int reps = n > 10000000 ? 1 : 3;
+    auto build = [&] { return Chain<Node, T>(values); };
+    print_row("radix_sort<" + name + ">", n, best_ns_per_element(n, reps, build, [&](auto &chain) {
+        chain.head = radix_sort(chain.head, key);
+        check_sorted(chain.head);
+    }));
+    print_row("merge_sort<" + name + ">", n, best_ns_per_element(n, reps, build, [](auto &chain) {
+        chain.head = merge_sort(chain.head);
+        check_sorted(chain.head);
+    }));
+}
+
+int main(int argc, char **argv) {
+    print_header("LSD radix sort vs merge_sort");
+    for (size_t n: bench_sizes(argc, argv, {1000000, 10000000, 100000000})) {
+        std::vector<int> ints = random_ints(n);
+        run<SinglyNode<int> >("SinglyNode<int>", ints, std::identity{});
+        run<DoublyNode<int> >("DoublyNode<int>", ints, std::identity{});
+
+        std::vector<int> small(ints);
+        for (int &v: small) v &= 0xFFFF;
+        run<SinglyNode<int> >("SinglyNode<int>, 16-bit keys", small, std::identity{});
+        ints = {};
+        small = {};
+
+        std::vector<Record> records(n);
+        std::mt19937_64 rng(7);
+        for (Record &r: records) r = {rng(), 1.0};
+        run<SinglyNode<Record> >("SinglyNode<Record>, key &Record::id", records, &Record::id);
+    }
+    return 0;
+}
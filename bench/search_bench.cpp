@@ -0,0 +1,50 @@
+﻿#include "bench.h"
+#include "../list/doubly_linked_list.h"
+#include "../list/unrolled_linked_list.h"
+
+// Every lookup misses, so each one scans the whole list.
+template<typename T>
+void run(const char *type, size_t n) {
+    constexpr int reps = 5;
+    const T missing = T(-1);
+
+    DoublyLinkedList<T> doubly;
+    UnrolledLinkedList<T> unrolled;
+    for (size_t i = 0; i < n; ++i) {
+        doubly.push_back(T(i % 1000));
+        unrolled.push_back(T(i % 1000));
+    }
+
+    auto name = [&](const char *what) { return std::string(what) + "<" + type + ">"; };
+
+    print_row(name("doubly contains"), n, best_ns_per_element(n, reps,
+        [] { return 0; },
+        [&](int &) { do_not_optimize(doubly.contains(missing)); }));
+
+    print_row(name("unrolled find_if (scalar)"), n, best_ns_per_element(n, reps,
+        [] { return 0; },
+        [&](int &) {
+            auto it = unrolled.find_if([&](const T &v) { return v == missing; });
+            do_not_optimize(it != unrolled.end());
+        }));
+
+    print_row(name("unrolled contains (simd)"), n, best_ns_per_element(n, reps,
+        [] { return 0; },
+        [&](int &) { do_not_optimize(unrolled.contains(missing)); }));
+
+    print_row(name("unrolled count_of (simd)"), n, best_ns_per_element(n, reps,
+        [] { return 0; },
+        [&](int &) { do_not_optimize(unrolled.count_of(T(7))); }));
+}
+
+int main(int argc, char **argv) {
+    std::printf("simd_width = %zu bytes\n", simd_width);
+    print_header("contains(): pointer chasing vs scalar vs vector kernel");
+
+    for (size_t n: bench_sizes(argc, argv, {1000, 100000, 1000000})) {
+        run<int32_t>("int32", n);
+        run<uint64_t>("uint64", n);
+        run<float>("float", n);
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+﻿#include <mutex>
+#include <thread>
+#include "bench.h"
+#include "../list/doubly_linked_list.h"
+#include "../list/sharded_list.h"
+
+// What ShardedList replaces: one DoublyLinkedList behind one mutex.
+template<typename T>
+class LockedList {
+    mutable std::mutex mutex;
+    DoublyLinkedList<T> list;
+
+public:
+    void push_back(const T &value) {
+        std::lock_guard lock(mutex);
+        list.push_back(value);
+    }
+
+    bool contains(const T &value) const {
+        std::lock_guard lock(mutex);
+        return list.contains(value);
+    }
+
+    bool remove(const T &value) {
+        std::lock_guard lock(mutex);
+        return list.remove(value);
+    }
+
+    size_t size() const {
+        std::lock_guard lock(mutex);
+        return list.size();
+    }
+};
+
+// Out of every 100 operations: `reads` contains() calls, one size(), and
+// the rest split evenly between push_back() and remove().
+struct Mix {
+    const char *name;
+    unsigned reads;
+};
+
+constexpr int key_range = 4096;
+
+// `ops` operations spread over `threads` threads on a list prefilled with
+// half the key range; the result is wall time per operation.
+template<typename List>
+double run(size_t threads, size_t ops, Mix mix) {
+    return best_ns_per_element(ops, 3,
+        [] {
+            auto list = std::make_unique<List>();
+            for (int v: random_ints(key_range / 2)) list->push_back(v & (key_range - 1));
+            return list;
+        },
+        [&](std::unique_ptr<List> &list) {
+            std::vector<std::thread> workers;
+            for (size_t t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t] {
+                    uint32_t x = 2463534242u + static_cast<uint32_t>(t) * 7919u;
+                    size_t hits = 0;
+                    for (size_t i = t; i < ops; i += threads) {
+                        x ^= x << 13;
+                        x ^= x >> 17;
+                        x ^= x << 5;
+                        const int key = static_cast<int>(x & (key_range - 1));
+                        const unsigned roll = (x >> 12) % 100;
+                        if (roll < mix.reads) hits += list->contains(key);
+                        else if (roll == mix.reads) hits += list->size();
+                        else if (roll & 1) list->push_back(key);
+                        else hits += list->remove(key);
+                    }
+                    do_not_optimize(hits);
+                });
+            }
+            for (auto &worker: workers) worker.join();
+        });
+}
+
+int main(int argc, char **argv) {
+    const size_t ops = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 400000;
+    print_header("ShardedList vs mutex + DoublyLinkedList (ns per operation)");
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+
+    for (Mix mix: {Mix{"read-mostly", 90}, Mix{"write-heavy", 20}}) {
+        for (size_t threads: {1, 2, 4, 8, 16, 32, 64}) {
+            std::string suffix = std::string(" ") + mix.name + " x" + std::to_string(threads);
+            print_row("LockedList" + suffix, ops, run<LockedList<int> >(threads, ops, mix));
+            print_row("ShardedList" + suffix, ops, run<ShardedList<int> >(threads, ops, mix));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,48 @@
+﻿#include "bench.h"
+#include "../list/doubly_linked_list.h"
+#include "../list/sorted_skip_list.h"
+
+// Lookups in a sorted sequence: linear DoublyLinkedList::contains against
+// the SortedSkipList express lanes. Times are per lookup; half of the keys
+// are hits and half are misses.
+int main(int argc, char **argv) {
+    constexpr int reps = 5;
+    constexpr size_t lookups = 1000;
+    print_header("sorted lookup: DoublyLinkedList vs SortedSkipList");
+
+    for (size_t n: bench_sizes(argc, argv, {1000, 10000, 100000, 1000000})) {
+        std::vector<int> values = random_ints(n);
+        std::vector<int> sorted = values;
+        std::sort(sorted.begin(), sorted.end());
+
+        std::vector<int> keys(lookups);
+        std::mt19937 rng(11);
+        for (size_t i = 0; i < lookups; ++i) {
+            int v = values[rng() % n];
+            keys[i] = i % 2 ? v : v + 1;
+        }
+
+        DoublyLinkedList<int> list;
+        for (int v: sorted) list.push_back(v);
+        SortedSkipList<int> skip;
+        for (int v: values) skip.insert_sorted(v);
+
+        // The linear scan is far too slow to repeat 1000 times at 1e6.
+        const size_t linear_lookups = n <= 100000 ? lookups : 50;
+        print_row("DoublyLinkedList::contains", n,
+                  best_ns_per_element(linear_lookups, reps, [] { return 0; }, [&](int &) {
+                      for (size_t i = 0; i < linear_lookups; ++i) do_not_optimize(list.contains(keys[i]));
+                  }));
+        print_row("SortedSkipList::contains", n,
+                  best_ns_per_element(lookups, reps, [] { return 0; }, [&](int &) {
+                      for (int k: keys) do_not_optimize(skip.contains(k));
+                  }));
+        print_row("SortedSkipList::insert_sorted", n,
+                  best_ns_per_element(n, 1, [] { return 0; }, [&](int &) {
+                      SortedSkipList<int> fresh;
+                      for (int v: values) fresh.insert_sorted(v);
+                      do_not_optimize(fresh.front());
+                  }));
+    }
+    return 0;
+}
@@ -0,0 +1,30 @@
+﻿#include "bench.h"
+#include "../list/doubly_linked_list.h"
+#include "../list/singly_linked_list.h"
+
+// Short-lived small lists: construct, push n ints, destroy, repeated. With
+// Inline >= n no cycle touches the allocator.
+template<typename List>
+void run(const std::string &name, size_t n) {
+    const size_t cycles = 200000;
+    print_row(name + " create/fill/destroy", n, best_ns_per_element(cycles, 5, [] { return 0; }, [&](int &) {
+        for (size_t c = 0; c < cycles; ++c) {
+            List list;
+            for (size_t i = 0; i < n; ++i) list.push_back(static_cast<int>(i));
+            do_not_optimize(list.back());
+        }
+    }));
+}
+
+int main(int argc, char **argv) {
+    print_header("small lists, ns per cycle");
+    for (size_t n: bench_sizes(argc, argv, {1, 2, 4, 8, 12, 16})) {
+        run<SinglyLinkedList<int> >("SinglyLinkedList", n);
+        run<SmallSinglyLinkedList<int, 8> >("SmallSinglyLinkedList<8>", n);
+        run<SmallSinglyLinkedList<int, 16> >("SmallSinglyLinkedList<16>", n);
+        run<DoublyLinkedList<int> >("DoublyLinkedList", n);
+        run<SmallDoublyLinkedList<int, 8> >("SmallDoublyLinkedList<8>", n);
+        run<SmallDoublyLinkedList<int, 16> >("SmallDoublyLinkedList<16>", n);
+    }
+    return 0;
+}
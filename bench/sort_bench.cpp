@@ -0,0 +1,73 @@
+﻿#include <algorithm>
+#include <list>
+#include <vector>
+#include "bench.h"
+#include "../algorithm/sort.cpp"
+
+// Nodes live in a vector and are linked in storage order, which is what a
+// freshly built list looks like; std::list gets the same chance.
+template<typename Node>
+struct Chain {
+    std::vector<Node> nodes;
+    Node *head = nullptr;
+
+    explicit Chain(const std::vector<int> &values) {
+        nodes.reserve(values.size());
+        for (int v: values) nodes.emplace_back(v);
+        for (size_t i = 0; i + 1 < nodes.size(); ++i) {
+            nodes[i].next = &nodes[i + 1];
+            if constexpr (is_doubly_v<Node>) nodes[i + 1].prev = &nodes[i];
+        }
+        if (!nodes.empty()) head = &nodes[0];
+    }
+};
+
+template<typename Node>
+bool is_sorted_chain(const Node *head) {
+    for (; head && head->next; head = head->next) {
+        if (head->next->data < head->data) return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    constexpr int reps = 5;
+    print_header("merge_sort vs std::list::sort vs vector + std::sort");
+
+    for (size_t n: bench_sizes(argc, argv, {1000, 100000, 1000000, 4000000})) {
+        std::vector<int> values = random_ints(n);
+
+        print_row("merge_sort<SinglyNode>", n, best_ns_per_element(n, reps,
+            [&] { return Chain<SinglyNode<int> >(values); },
+            [](auto &chain) {
+                chain.head = merge_sort(chain.head);
+                if (!is_sorted_chain(chain.head)) std::abort();
+            }));
+
+        print_row("merge_sort<DoublyNode>", n, best_ns_per_element(n, reps,
+            [&] { return Chain<DoublyNode<int> >(values); },
+            [](auto &chain) {
+                chain.head = merge_sort(chain.head);
+                if (!is_sorted_chain(chain.head)) std::abort();
+            }));
+
+        print_row("std::list::sort", n, best_ns_per_element(n, reps,
+            [&] { return std::list<int>(values.begin(), values.end()); },
+            [](auto &list) {
+                list.sort();
+                do_not_optimize(list.front());
+            }));
+
+        print_row("copy to vector + std::sort", n, best_ns_per_element(n, reps,
+            [&] { return Chain<SinglyNode<int> >(values); },
+            [](auto &chain) {
+                std::vector<int> buffer;
+                for (auto *curr = chain.head; curr; curr = curr->next) buffer.push_back(curr->data);
+                std::sort(buffer.begin(), buffer.end());
+                size_t i = 0;
+                for (auto *curr = chain.head; curr; curr = curr->next) curr->data = buffer[i++];
+                do_not_optimize(chain.head->data);
+            }));
+    }
+    return 0;
+}
@@ -0,0 +1,35 @@
+﻿#include "bench.h"
+#include "../list/doubly_linked_list.h"
+#include "../list/list_stats.h"
+#include "../list/singly_linked_list.h"
+
+// What ListStats costs on the hot paths: push/pop churn and contains()
+// misses, each with and without the policy.
+template<typename List>
+void run(const std::string &name, size_t n) {
+    std::vector<int> values = random_ints(n);
+    print_row(name + " push_back+pop_front", n, best_ns_per_element(n, 3, [] { return 0; }, [&](int &) {
+        List list;
+        for (int v: values) list.push_back(v);
+        for (size_t i = 0; i < n; ++i) do_not_optimize(list.pop_front());
+    }));
+
+    List list;
+    list.append_range(values);
+    const size_t lookups = 64;
+    print_row(name + " contains (miss)", n * lookups, best_ns_per_element(n * lookups, 3, [] { return 0; },
+        [&](int &) {
+            for (size_t i = 0; i < lookups; ++i) do_not_optimize(list.contains(static_cast<int>(i)));
+        }));
+}
+
+int main(int argc, char **argv) {
+    print_header("stats policy overhead");
+    for (size_t n: bench_sizes(argc, argv, {100000})) {
+        run<SinglyLinkedList<int> >("SinglyLinkedList<NoStats>", n);
+        run<SinglyLinkedList<int, std::allocator<int>, NoPrefetch, ListStats> >("SinglyLinkedList<ListStats>", n);
+        run<DoublyLinkedList<int> >("DoublyLinkedList<NoStats>", n);
+        run<DoublyLinkedList<int, std::allocator<int>, NoPrefetch, ListStats> >("DoublyLinkedList<ListStats>", n);
+    }
+    return 0;
+}
@@ -0,0 +1,241 @@
+﻿#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <forward_list>
+#include <list>
+#include "bench.h"
+#include "../list/circular_linked_list.h"
+#include "../list/doubly_linked_list.h"
+#include "../list/singly_linked_list.h"
+#include "../list/unrolled_linked_list.h"
+#include "../list/xor_linked_list.h"
+
+// Every container x payload x operation x size, printed as a table and
+// optionally written as JSON for regression tracking.
+//
+//   suite_bench [--max-size N] [--json FILE] [--filter TEXT]
+//
+// Sizes run in powers of ten from 1e2 up to --max-size (default 1e6; the
+// 1e8 end of the range needs several GB). --filter keeps only benchmarks
+// whose name contains TEXT.
+
+struct Payload64 {
+    uint64_t key;
+    char pad[56];
+
+    bool operator==(const Payload64 &o) const { return key == o.key; }
+    bool operator<(const Payload64 &o) const { return key < o.key; }
+};
+
+static_assert(sizeof(Payload64) == 64);
+
+template<typename T>
+T make_value(uint32_t i) {
+    if constexpr (std::is_same_v<T, int>) {
+        return static_cast<int>(i);
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        std::string s = "payload-string-beyond-sso-";
+        s += std::to_string(i);
+        return s;
+    } else {
+        Payload64 p{};
+        p.key = i;
+        return p;
+    }
+}
+
+template<typename T>
+uint64_t key_of(const T &value) {
+    if constexpr (std::is_same_v<T, int>) return static_cast<uint64_t>(value);
+    else if constexpr (std::is_same_v<T, std::string>) return value.size();
+    else return value.key;
+}
+
+template<typename C, typename T>
+void push(C &c, T value) {
+    if constexpr (requires { c.push_back(std::move(value)); }) c.push_back(std::move(value));
+    else c.push_front(std::move(value));
+}
+
+template<typename C, typename T>
+bool contains(C &c, const T &value) {
+    if constexpr (requires { c.contains(value); }) return c.contains(value);
+    else return std::find(c.begin(), c.end(), value) != c.end();
+}
+
+template<typename T>
+bool remove_one(std::list<T> &c, const T &value) {
+    auto it = std::find(c.begin(), c.end(), value);
+    if (it == c.end()) return false;
+    c.erase(it);
+    return true;
+}
+
+template<typename T>
+bool remove_one(std::deque<T> &c, const T &value) {
+    auto it = std::find(c.begin(), c.end(), value);
+    if (it == c.end()) return false;
+    c.erase(it);
+    return true;
+}
+
+template<typename T>
+bool remove_one(std::forward_list<T> &c, const T &value) {
+    for (auto prev = c.before_begin(), it = c.begin(); it != c.end(); prev = it, ++it) {
+        if (*it == value) {
+            c.erase_after(prev);
+            return true;
+        }
+    }
+    return false;
+}
+
+template<typename C, typename T>
+bool remove_one(C &c, const T &value) {
+    return c.remove(value);
+}
+
+template<typename C>
+void sort(C &c) {
+    if constexpr (requires { c.sort(); }) c.sort();
+    else std::sort(c.begin(), c.end());
+}
+
+template<typename C, typename T>
+constexpr bool sortable = requires(C &c) { c.sort(); } || std::is_same_v<C, std::deque<T> >;
+
+struct Suite {
+    size_t max_size = 1000000;
+    const char *json = nullptr;
+    const char *filter = nullptr;
+    std::vector<BenchResult> results;
+
+    // Repeats small cases so each timed region covers enough elements to be
+    // measurable; large cases get fewer repetitions.
+    static size_t batch_for(size_t n) { return std::max<size_t>(1, 100000 / n); }
+    static int reps_for(size_t n) { return n <= 10000 ? 10 : n <= 1000000 ? 5 : 1; }
+
+    void record(const char *container, const char *payload, const char *op, size_t n, double ns) {
+        std::string name = std::string(container) + "/" + payload + "/" + op;
+        print_row(name, n, ns);
+        results.push_back({container, payload, op, n, ns});
+    }
+
+    bool wanted(const char *container, const char *payload, const char *op) const {
+        if (!filter) return true;
+        std::string name = std::string(container) + "/" + payload + "/" + op;
+        return name.find(filter) != std::string::npos;
+    }
+
+    template<typename C, typename T>
+    void run(const char *container, const char *payload) {
+        for (size_t n = 100; n <= max_size; n *= 10) {
+            const size_t batch = batch_for(n);
+            const size_t total = n * batch;
+            const int reps = reps_for(n);
+
+            // Values are a shuffled permutation of 0..n-1, so sort has work to
+            // do and n itself is a guaranteed miss.
+            std::vector<uint32_t> order(n);
+            for (size_t i = 0; i < n; ++i) order[i] = static_cast<uint32_t>(i);
+            std::shuffle(order.begin(), order.end(), std::mt19937(7));
+
+            auto empty = [&] {
+                std::vector<C> cs(batch);
+                return cs;
+            };
+            auto filled = [&] {
+                std::vector<C> cs(batch);
+                for (C &c: cs) {
+                    for (uint32_t v: order) push(c, make_value<T>(v));
+                }
+                return cs;
+            };
+
+            if (wanted(container, payload, "push")) {
+                record(container, payload, "push", n, best_ns_per_element(total, reps, empty, [&](auto &cs) {
+                    for (C &c: cs) {
+                        for (uint32_t v: order) push(c, make_value<T>(v));
+                    }
+                }));
+            }
+            if (wanted(container, payload, "pop")) {
+                record(container, payload, "pop", n, best_ns_per_element(total, reps, filled, [&](auto &cs) {
+                    for (C &c: cs) {
+                        for (size_t i = 0; i < n; ++i) c.pop_front();
+                    }
+                }));
+            }
+
+            std::vector<C> shared = filled();
+            if (wanted(container, payload, "iterate")) {
+                record(container, payload, "iterate", n, best_ns_per_element(total, reps, [] { return 0; },
+                    [&](int &) {
+                        uint64_t sum = 0;
+                        for (C &c: shared) {
+                            for (auto it = c.begin(); it != c.end(); ++it) sum += key_of(*it);
+                        }
+                        do_not_optimize(sum);
+                    }));
+            }
+            if (wanted(container, payload, "contains")) {
+                const T missing = make_value<T>(static_cast<uint32_t>(n));
+                record(container, payload, "contains", n, best_ns_per_element(total, reps, [] { return 0; },
+                    [&](int &) {
+                        for (C &c: shared) do_not_optimize(contains(c, missing));
+                    }));
+            }
+            shared.clear();
+
+            if (wanted(container, payload, "remove")) {
+                const T middle = make_value<T>(order[n / 2]);
+                record(container, payload, "remove", n, best_ns_per_element(total, reps, filled, [&](auto &cs) {
+                    for (C &c: cs) do_not_optimize(remove_one(c, middle));
+                }));
+            }
+            if constexpr (sortable<C, T>) {
+                if (wanted(container, payload, "sort")) {
+                    record(container, payload, "sort", n, best_ns_per_element(total, reps, filled, [&](auto &cs) {
+                        for (C &c: cs) sort(c);
+                    }));
+                }
+            }
+        }
+    }
+
+    template<typename T>
+    void run_payload(const char *payload) {
+        run<SinglyLinkedList<T>, T>("SinglyLinkedList", payload);
+        run<DoublyLinkedList<T>, T>("DoublyLinkedList", payload);
+        run<CircularLinkedList<T>, T>("CircularLinkedList", payload);
+        run<XORLinkedList<T>, T>("XORLinkedList", payload);
+        run<UnrolledLinkedList<T>, T>("UnrolledLinkedList", payload);
+        run<std::list<T>, T>("std::list", payload);
+        run<std::forward_list<T>, T>("std::forward_list", payload);
+        run<std::deque<T>, T>("std::deque", payload);
+    }
+};
+
+int main(int argc, char **argv) {
+    Suite suite;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!std::strcmp(argv[i], "--max-size")) suite.max_size = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--json")) suite.json = argv[i + 1];
+        else if (!std::strcmp(argv[i], "--filter")) suite.filter = argv[i + 1];
+        else {
+            std::fprintf(stderr, "usage: %s [--max-size N] [--json FILE] [--filter TEXT]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    print_header("linked-lists benchmark suite");
+    suite.run_payload<int>("int");
+    suite.run_payload<std::string>("string");
+    suite.run_payload<Payload64>("struct64");
+
+    if (suite.json && !write_json(suite.json, suite.results)) {
+        std::fprintf(stderr, "could not write %s\n", suite.json);
+        return 1;
+    }
+    return 0;
+}
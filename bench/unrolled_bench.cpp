@@ -0,0 +1,47 @@
+﻿#include <list>
+#include "bench.h"
+#include "../list/doubly_linked_list.h"
+#include "../list/unrolled_linked_list.h"
+
+template<typename List>
+List build(const std::vector<int> &values) {
+    List list;
+    for (int v: values) list.push_back(v);
+    return list;
+}
+
+template<typename List>
+void run(const char *name, const std::vector<int> &values) {
+    constexpr int reps = 5;
+    const size_t n = values.size();
+    List list = build<List>(values);
+
+    print_row(std::string(name) + " iterate", n, best_ns_per_element(n, reps,
+        [] { return 0; },
+        [&](int &) {
+            long long sum = 0;
+            for (auto it = list.begin(); it != list.end(); ++it) sum += *it;
+            do_not_optimize(sum);
+        }));
+
+    // -1 never occurs in the data, so every lookup walks the whole list.
+    if constexpr (requires { list.contains(0); }) {
+        print_row(std::string(name) + " contains(miss)", n, best_ns_per_element(n, reps,
+            [] { return 0; },
+            [&](int &) { do_not_optimize(list.contains(-1)); }));
+    }
+}
+
+int main(int argc, char **argv) {
+    print_header("traversal: DoublyLinkedList vs UnrolledLinkedList");
+
+    for (size_t n: bench_sizes(argc, argv, {1000, 100000, 1000000, 10000000})) {
+        std::vector<int> values = random_ints(n);
+        for (int &v: values) v &= 0x7fffffff;
+
+        run<DoublyLinkedList<int> >("DoublyLinkedList", values);
+        run<UnrolledLinkedList<int> >("UnrolledLinkedList", values);
+        run<std::list<int> >("std::list", values);
+    }
+    return 0;
+}
@@ -0,0 +1,129 @@
+﻿#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include "bench.h"
+#include "../list/doubly_linked_list.h"
+#include "../list/work_stealing_pool.h"
+
+// The per-thread task stacks the work-stealing deque replaces: a
+// DoublyLinkedList behind a mutex, the owner at the back, thieves at the
+// front.
+template<typename T>
+class LockedDeque {
+    std::mutex mutex;
+    DoublyLinkedList<T> list;
+
+public:
+    void push_back(T value) {
+        std::lock_guard lock(mutex);
+        list.push_back(value);
+    }
+
+    std::optional<T> try_pop_back() {
+        std::lock_guard lock(mutex);
+        if (list.empty()) return std::nullopt;
+        return list.pop_back();
+    }
+
+    std::optional<T> try_steal_front() {
+        std::lock_guard lock(mutex);
+        if (list.empty()) return std::nullopt;
+        return list.pop_front();
+    }
+};
+
+constexpr int fib_cutoff = 10;
+
+long long fib_serial(int n) { return n < 2 ? n : fib_serial(n - 1) + fib_serial(n - 2); }
+
+// Forks fib(n - 1), computes fib(n - 2) itself and joins.
+template<typename Pool>
+long long fib(Pool &pool, int n) {
+    if (n < fib_cutoff) return fib_serial(n);
+    long long a = 0;
+    typename Pool::TaskGroup group;
+    pool.spawn(group, [&pool, &a, n] { a = fib(pool, n - 1); });
+    long long b = fib(pool, n - 2);
+    pool.wait(group);
+    return a + b;
+}
+
+size_t fib_tasks(int n) { return n < fib_cutoff ? 0 : 1 + fib_tasks(n - 1) + fib_tasks(n - 2); }
+
+struct Tree {
+    long long value;
+    std::unique_ptr<Tree> left;
+    std::unique_ptr<Tree> right;
+};
+
+std::unique_ptr<Tree> build_tree(int depth, long long &next) {
+    if (depth == 0) return nullptr;
+    auto node = std::make_unique<Tree>();
+    node->value = next++;
+    node->left = build_tree(depth - 1, next);
+    node->right = build_tree(depth - 1, next);
+    return node;
+}
+
+constexpr int tree_cutoff = 4;
+
+long long sum_serial(const Tree *node) {
+    return node ? node->value + sum_serial(node->left.get()) + sum_serial(node->right.get()) : 0;
+}
+
+// Forks the left subtree down to subtrees of tree_cutoff levels.
+template<typename Pool>
+long long tree_sum(Pool &pool, const Tree *node, int depth) {
+    if (depth <= tree_cutoff) return sum_serial(node);
+    long long left = 0;
+    typename Pool::TaskGroup group;
+    pool.spawn(group, [&pool, &left, node, depth] { left = tree_sum(pool, node->left.get(), depth - 1); });
+    long long right = tree_sum(pool, node->right.get(), depth - 1);
+    pool.wait(group);
+    return node->value + left + right;
+}
+
+// Runs body on a pool worker, the way a fork/join program starts, and
+// checks its result.
+template<typename Pool, typename Body>
+double run(size_t threads, size_t tasks, long long expected, Body body) {
+    Pool pool(threads);
+    return best_ns_per_element(tasks, 3, [] { return 0; }, [&](int &) {
+        long long result = 0;
+        typename Pool::TaskGroup group;
+        pool.spawn(group, [&] { result = body(pool); });
+        pool.wait(group);
+        if (result != expected) std::abort();
+    });
+}
+
+int main(int argc, char **argv) {
+    const int n = argc > 1 ? std::atoi(argv[1]) : 32;
+    const int depth = argc > 2 ? std::atoi(argv[2]) : 22;
+    using Stealing = WorkStealingPool<>;
+    using Locked = WorkStealingPool<LockedDeque>;
+
+    print_header("fork/join: WorkStealingDeque vs mutex + DoublyLinkedList (ns per task)");
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+
+    const long long fib_expected = fib_serial(n);
+    const size_t fib_count = fib_tasks(n);
+    long long next = 0;
+    const std::unique_ptr<Tree> tree = build_tree(depth, next);
+    const long long tree_expected = next * (next - 1) / 2;
+    const size_t tree_count = (size_t{1} << (depth - tree_cutoff)) - 1;
+
+    for (size_t threads: {1, 2, 4, 8, 16}) {
+        const std::string suffix = " x" + std::to_string(threads);
+        print_row("fib(" + std::to_string(n) + ") locked" + suffix, fib_count,
+                  run<Locked>(threads, fib_count, fib_expected, [n](Locked &pool) { return fib(pool, n); }));
+        print_row("fib(" + std::to_string(n) + ") stealing" + suffix, fib_count,
+                  run<Stealing>(threads, fib_count, fib_expected, [n](Stealing &pool) { return fib(pool, n); }));
+        print_row("tree sum locked" + suffix, tree_count, run<Locked>(threads, tree_count, tree_expected,
+            [&](Locked &pool) { return tree_sum(pool, tree.get(), depth); }));
+        print_row("tree sum stealing" + suffix, tree_count, run<Stealing>(threads, tree_count, tree_expected,
+            [&](Stealing &pool) { return tree_sum(pool, tree.get(), depth); }));
+    }
+    return 0;
+}
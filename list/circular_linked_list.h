@@ -1,25 +1,192 @@
 ﻿#ifndef CIRCULAR_LINKED_LIST_H
 #define CIRCULAR_LINKED_LIST_H
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <ranges>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "../algorithm/prefetch.h"
+#include "../algorithm/sort.cpp"
+#include "../algorithm/traits.h"
+#include "../memory/node_blocks.h"
+#include "list_stats.h"
 
-template<typename T>
+template<typename T, typename Alloc = std::allocator<T>, typename Prefetch = NoPrefetch, typename Stats = NoStats>
 class CircularLinkedList {
 private:
     struct Node {
         T data;
         Node *prev;
         Node *next;
+        [[no_unique_address]] JumpLink<Node, prefetch_enabled_v<Prefetch> > link;
 
-        Node(const T &val) : data(val), prev(this), next(this) {
+        template<typename... Args>
+        explicit Node(Args &&... args) : data(std::forward<Args>(args)...), prev(this), next(this) {
         }
     };
 
+    using NodeAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAlloc>;
+
     Node *head = nullptr;
     size_t count = 0;
+    [[no_unique_address]] NodeAlloc alloc;
+    NodeBlocks<Node, NodeAlloc> blocks;
+    [[no_unique_address]] mutable Stats recorder;
+
+    template<typename... Args>
+    Node *create_node(Args &&... args) {
+        Node *node = NodeTraits::allocate(alloc, 1);
+        try {
+            NodeTraits::construct(alloc, node, std::forward<Args>(args)...);
+        } catch (...) {
+            NodeTraits::deallocate(alloc, node, 1);
+            throw;
+        }
+        recorder.on_allocate();
+        return node;
+    }
+
+    void destroy_node(Node *node) {
+        NodeTraits::destroy(alloc, node);
+        recorder.on_free();
+        if (!blocks.release(alloc, node)) NodeTraits::deallocate(alloc, node, 1);
+    }
+
+    // Unlinked nodes from a bulk removal, chained through next.
+    void free_chain(Node *node) {
+        while (node) {
+            Node *next = node->next;
+            destroy_node(node);
+            node = next;
+        }
+    }
+
+    // Runs compact() when the trigger fires; a failed compaction leaves the
+    // ring untouched and is not reported.
+    void maybe_compact() {
+        if (!blocks.due(count) || fragmentation() <= blocks.threshold()) return;
+        try {
+            compact();
+        } catch (...) {
+        }
+    }
+
+    // Moves other's ring in before next, which must be in this ring unless
+    // this list is empty. Nodes change owner, so both lists must share an
+    // allocator.
+    void link_before(Node *next, CircularLinkedList &other) {
+        if (this == &other || !other.head) return;
+        if (!(alloc == other.alloc)) throw std::invalid_argument("Lists use different allocators");
+        blocks.take(other.blocks);
+
+        if (head) {
+            Node *prev = next->prev;
+            Node *first = other.head;
+            Node *last = other.head->prev;
+            prev->next = first;
+            first->prev = prev;
+            last->next = next;
+            next->prev = last;
+        } else {
+            head = other.head;
+        }
+        count += other.count;
+
+        other.head = nullptr;
+        other.count = 0;
+    }
+
+    // Cuts the ring in two: [head, first) stays and [first, head) becomes a
+    // new list. `kept` is how many nodes stay behind.
+    CircularLinkedList cut_before(Node *first, size_t kept) {
+        CircularLinkedList rest(get_allocator());
+        rest.blocks.share(blocks);
+        if (kept == 0) {
+            std::swap(head, rest.head);
+            std::swap(count, rest.count);
+            return rest;
+        }
+
+        Node *last = head->prev;
+        Node *prev = first->prev;
+        prev->next = head;
+        head->prev = prev;
+        last->next = first;
+        first->prev = last;
+
+        rest.head = first;
+        rest.count = count - kept;
+        count = kept;
+        return rest;
+    }
+
+    bool release_nodes() {
+        if constexpr (has_release_v<NodeAlloc> && std::is_trivially_destructible_v<T>) {
+            if (alloc.live() == count && blocks.empty()) {
+                recorder.on_free(count);
+                alloc.release();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Copies [first, last) into a detached ring in a single pass; count is
+    // written once at the end. The ring stays closed after every node so a
+    // throwing constructor leaves something clear() can walk.
+    template<typename It, typename S>
+    CircularLinkedList chain_of(It first, S last) {
+        CircularLinkedList chain(get_allocator());
+        size_t n = 0;
+        for (; first != last; ++first, ++n) {
+            Node *node = create_node(*first);
+            if (chain.head) {
+                Node *back = chain.head->prev;
+                node->prev = back;
+                node->next = chain.head;
+                back->next = node;
+                chain.head->prev = node;
+            } else {
+                chain.head = node;
+            }
+        }
+        chain.count = n;
+        return chain;
+    }
+
+    void append_chain(CircularLinkedList &&chain) { append(std::move(chain)); }
 
 public:
+    using value_type = T;
+    using reference = T &;
+    using const_reference = const T &;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using allocator_type = Alloc;
+
     CircularLinkedList() = default;
 
+    explicit CircularLinkedList(const Alloc &a) : alloc(a) {
+    }
+
+    template<std::input_iterator It, std::sentinel_for<It> S>
+    CircularLinkedList(It first, S last, const Alloc &a = Alloc()) : alloc(a) {
+        append_chain(chain_of(std::move(first), std::move(last)));
+    }
+
+    // Builds a list from any input range, reading it exactly once, so
+    // generators and istream views need no intermediate buffer.
+    template<std::ranges::input_range R>
+    static CircularLinkedList from_stream(R &&input, const Alloc &a = Alloc()) {
+        CircularLinkedList list(a);
+        list.append_range(std::forward<R>(input));
+        return list;
+    }
+
     ~CircularLinkedList() { clear(); }
 
     CircularLinkedList(const CircularLinkedList &) = delete;
@@ -27,7 +194,7 @@ public:
     CircularLinkedList &operator=(const CircularLinkedList &) = delete;
 
     CircularLinkedList(CircularLinkedList &&other) noexcept
-        : head(other.head), count(other.count) {
+        : head(other.head), count(other.count), alloc(other.alloc), blocks(std::move(other.blocks)) {
         other.head = nullptr;
         other.count = 0;
     }
@@ -37,14 +204,21 @@ public:
             clear();
             head = other.head;
             count = other.count;
+            alloc = other.alloc;
+            blocks = std::move(other.blocks);
             other.head = nullptr;
             other.count = 0;
         }
         return *this;
     }
 
-    void push_front(const T &value) {
-        Node *node = new Node(value);
+    void push_front(const T &value) { emplace_front(value); }
+
+    void push_front(T &&value) { emplace_front(std::move(value)); }
+
+    template<typename... Args>
+    T &emplace_front(Args &&... args) {
+        Node *node = create_node(std::forward<Args>(args)...);
         if (head) {
             node->next = head;
             node->prev = head->prev;
@@ -53,10 +227,18 @@ public:
         }
         head = node;
         ++count;
+        recorder.on_push();
+        maybe_compact();
+        return head->data;
     }
 
-    void push_back(const T &value) {
-        Node *node = new Node(value);
+    void push_back(const T &value) { emplace_back(value); }
+
+    void push_back(T &&value) { emplace_back(std::move(value)); }
+
+    template<typename... Args>
+    T &emplace_back(Args &&... args) {
+        Node *node = create_node(std::forward<Args>(args)...);
         if (head) {
             node->next = head;
             node->prev = head->prev;
@@ -66,12 +248,15 @@ public:
             head = node;
         }
         ++count;
+        recorder.on_push();
+        maybe_compact();
+        return head->prev->data;
     }
 
     T pop_front() {
         if (!head) throw std::runtime_error("List is empty");
         Node *node = head;
-        T value = node->data;
+        T value = std::move(node->data);
 
         if (count == 1) {
             head = nullptr;
@@ -80,15 +265,17 @@ public:
             head->next->prev = head->prev;
             head = head->next;
         }
-        delete node;
+        destroy_node(node);
         --count;
+        recorder.on_pop();
+        maybe_compact();
         return value;
     }
 
     T pop_back() {
         if (!head) throw std::runtime_error("List is empty");
         Node *node = head->prev;
-        T value = node->data;
+        T value = std::move(node->data);
 
         if (count == 1) {
             head = nullptr;
@@ -96,8 +283,10 @@ public:
             node->prev->next = head;
             head->prev = node->prev;
         }
-        delete node;
+        destroy_node(node);
         --count;
+        recorder.on_pop();
+        maybe_compact();
         return value;
     }
 
@@ -120,21 +309,40 @@ public:
     }
 
     bool contains(const T &value) const {
-        if (!head) return false;
+        if (!head) {
+            recorder.on_contains(0);
+            return false;
+        }
+        JumpWindow<Node, Prefetch> window;
+        size_t visited = 0;
         Node *curr = head;
         do {
-            if (curr->data == value) return true;
+            window.visit(curr);
+            ++visited;
+            if (curr->data == value) {
+                recorder.on_contains(visited);
+                return true;
+            }
             curr = curr->next;
         } while (curr != head);
+        recorder.on_contains(visited);
         return false;
     }
 
     bool remove(const T &value) {
-        if (!head) return false;
+        if (!head) {
+            recorder.on_remove(0);
+            return false;
+        }
 
+        JumpWindow<Node, Prefetch> window;
+        size_t visited = 0;
         Node *curr = head;
         do {
+            window.visit(curr);
+            ++visited;
             if (curr->data == value) {
+                recorder.on_remove(visited);
                 if (count == 1) {
                     head = nullptr;
                 } else {
@@ -142,55 +350,288 @@ public:
                     curr->next->prev = curr->prev;
                     if (curr == head) head = head->next;
                 }
-                delete curr;
+                destroy_node(curr);
                 --count;
+                maybe_compact();
                 return true;
             }
             curr = curr->next;
         } while (curr != head);
+        recorder.on_remove(visited);
         return false;
     }
 
+    // Removes every element satisfying pred, visiting each node once
+    // starting at head, and returns how many went. Nodes are freed in one
+    // batch after the scan, or when pred throws.
+    template<typename Pred>
+    size_t remove_if(Pred pred) {
+        JumpWindow<Node, Prefetch> window;
+        Node *dead = nullptr;
+        size_t removed = 0;
+        try {
+            Node *curr = head;
+            for (size_t left = count; left; --left) {
+                window.visit(curr);
+                Node *next = curr->next;
+                if (pred(curr->data)) {
+                    if (count == 1) {
+                        head = nullptr;
+                    } else {
+                        curr->prev->next = next;
+                        next->prev = curr->prev;
+                        if (curr == head) head = next;
+                    }
+                    curr->next = dead;
+                    dead = curr;
+                    --count;
+                    ++removed;
+                }
+                curr = next;
+            }
+        } catch (...) {
+            free_chain(dead);
+            throw;
+        }
+        free_chain(dead);
+        if (removed) maybe_compact();
+        return removed;
+    }
+
+    size_t remove_all(const T &value) {
+        return remove_if([&value](const T &x) { return x == value; });
+    }
+
+    // Keeps the first of every run of equal neighbours, reading from head
+    // round to the back; the wrap from back to head is not a neighbour.
+    template<typename Eq = std::equal_to<> >
+    size_t unique(Eq eq = {}) {
+        const T *kept = nullptr;
+        return remove_if([&](const T &x) {
+            if (kept && eq(*kept, x)) return true;
+            kept = &x;
+            return false;
+        });
+    }
+
+    // Removes every element contained in values, a std::set, an
+    // unordered_set or anything else with contains().
+    template<typename Set>
+        requires requires(const Set &s, const T &v) { { s.contains(v) } -> std::convertible_to<bool>; }
+    size_t erase(const Set &values) {
+        return remove_if([&values](const T &x) { return values.contains(x); });
+    }
+
     void clear() {
-        if (!head) return;
-        Node *curr = head;
-        do {
-            Node *tmp = curr;
-            curr = curr->next;
-            delete tmp;
-        } while (curr != head);
+        if (head && !release_nodes()) {
+            Node *curr = head;
+            do {
+                Node *tmp = curr;
+                JumpWindow<Node, Prefetch>::follow(tmp);
+                curr = curr->next;
+                destroy_node(tmp);
+            } while (curr != head);
+        }
         head = nullptr;
         count = 0;
+        blocks.reset();
+    }
+
+    // Moves the elements into one new array of nodes, starting at head, and
+    // relinks the ring in that order. Invalidates iterators and references.
+    // Values are copied only if moving T can throw; a failure then leaves
+    // the list unchanged.
+    void compact() {
+        if (!head) return;
+        Node *fresh = blocks.allocate(alloc, count);
+        size_t built = 0;
+        try {
+            Node *curr = head;
+            do {
+                NodeTraits::construct(alloc, fresh + built, std::move_if_noexcept(curr->data));
+                fresh[built++].next = curr;
+                curr = curr->next;
+            } while (curr != head);
+        } catch (...) {
+            while (built) NodeTraits::destroy(alloc, fresh + --built);
+            blocks.abandon(alloc, fresh);
+            throw;
+        }
+        recorder.on_compact();
+        recorder.on_allocate(count);
+        for (size_t i = 0; i < count; ++i) {
+            destroy_node(fresh[i].next);
+            fresh[i].next = fresh + (i + 1 == count ? 0 : i + 1);
+            fresh[i].prev = fresh + (i == 0 ? count - 1 : i - 1);
+        }
+        head = fresh;
+    }
+
+    // Share of the links from head around to its predecessor, from 0 to 1,
+    // that lead more than a few cache lines away. Walks the whole ring.
+    double fragmentation() const {
+        if (count < 2) return 0;
+        size_t far = 0;
+        for (Node *curr = head; curr->next != head; curr = curr->next) far += nodes_far_apart(curr, curr->next);
+        return static_cast<double>(far) / static_cast<double>(count - 1);
     }
 
+    // Compacts automatically once fragmentation() exceeds fraction, checked
+    // after roughly size() pushes, pops and removes; those may then
+    // invalidate iterators. 0 turns it off.
+    void set_compaction_threshold(double fraction) { blocks.set_threshold(fraction); }
+
+    Stats stats() const { return recorder; }
+
+    void reset_stats() { recorder = Stats(); }
+
+    // Breaks the ring after the back element, sorts the chain in place and
+    // joins the new back to the new front again.
+    template<typename Compare = std::less<> >
+    void sort(Compare comp = {}) {
+        if (count < 2) return;
+        head->prev->next = nullptr;
+        head->prev = nullptr;
+        Node *last = nullptr;
+        head = merge_sort(head, comp, &last);
+        last->next = head;
+        head->prev = last;
+    }
+
+    Alloc get_allocator() const { return Alloc(alloc); }
+
     size_t size() const { return count; }
     bool empty() const { return count == 0; }
 
-    class Iterator {
-        Node *curr;
-        Node *start;
-        bool done;
+    template<bool Const>
+    class BasicIterator {
+        Node *curr = nullptr;
+        Node *start = nullptr;
+        bool done = true;
+
+        friend class CircularLinkedList;
+        friend class BasicIterator<!Const>;
 
     public:
-        Iterator(Node *n, bool end = false)
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T *, T *>;
+        using reference = std::conditional_t<Const, const T &, T &>;
+
+        BasicIterator() = default;
+
+        BasicIterator(Node *n, bool end = false)
             : curr(n), start(n), done(end || !n) {
         }
 
-        T &operator*() { return curr->data; }
+        template<bool C = Const> requires C
+        BasicIterator(const BasicIterator<false> &o) : curr(o.curr), start(o.start), done(o.done) {
+        }
 
-        Iterator &operator++() {
+        reference operator*() const { return curr->data; }
+        pointer operator->() const { return &curr->data; }
+
+        BasicIterator &operator++() {
             curr = curr->next;
             if (curr == start) done = true;
             return *this;
         }
 
-        bool operator!=(const Iterator &o) const {
-            return !done || !o.done;
+        BasicIterator operator++(int) {
+            BasicIterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        // Every iterator that has gone once around the ring is end().
+        bool operator==(const BasicIterator &o) const {
+            return done == o.done && (done || curr == o.curr);
         }
     };
 
+    using Iterator = BasicIterator<false>;
+    using ConstIterator = BasicIterator<true>;
+    using iterator = Iterator;
+    using const_iterator = ConstIterator;
+
+    // Inserts other's elements before pos without allocating. O(1). Splicing
+    // at begin() makes other's first element the new head; at end() the
+    // elements go in just behind the current back.
+    void splice(Iterator pos, CircularLinkedList &other) {
+        if (!head) {
+            link_before(nullptr, other);
+            return;
+        }
+        Node *first = other.head;
+        bool at_front = !pos.done && pos.curr == head;
+        link_before(pos.done ? head : pos.curr, other);
+        if (at_front && first) head = first;
+    }
+
+    void append(CircularLinkedList &&other) {
+        if (head) link_before(head, other);
+        else link_before(nullptr, other);
+    }
+
+    // Replaces the contents. The new nodes are built before the old ones
+    // are freed, so a throwing element constructor leaves the list intact.
+    template<std::input_iterator It, std::sentinel_for<It> S>
+    void assign(It first, S last) {
+        CircularLinkedList chain = chain_of(std::move(first), std::move(last));
+        clear();
+        append_chain(std::move(chain));
+    }
+
+    template<std::ranges::input_range R>
+    void assign_range(R &&range) { assign(std::ranges::begin(range), std::ranges::end(range)); }
+
+    // The *_range members link the new nodes in one pass and update the
+    // size once.
+    template<std::ranges::input_range R>
+    void append_range(R &&range) { append_chain(chain_of(std::ranges::begin(range), std::ranges::end(range))); }
+
+    template<std::ranges::input_range R>
+    void prepend_range(R &&range) {
+        CircularLinkedList chain = chain_of(std::ranges::begin(range), std::ranges::end(range));
+        splice(begin(), chain);
+    }
+
+    // Inserts the range before pos.
+    template<std::ranges::input_range R>
+    void insert_range(Iterator pos, R &&range) {
+        CircularLinkedList chain = chain_of(std::ranges::begin(range), std::ranges::end(range));
+        splice(pos, chain);
+    }
+
+    // Keeps [begin, pos) and returns [pos, end). Walks up to pos.
+    CircularLinkedList split_at(Iterator pos) {
+        if (pos.done) return CircularLinkedList(get_allocator());
+        size_t kept = 0;
+        for (Node *curr = head; curr != pos.curr; curr = curr->next) ++kept;
+        return cut_before(pos.curr, kept);
+    }
+
+    // Keeps the first n elements and returns the rest, walking round the
+    // ring in whichever direction reaches the cut sooner.
+    CircularLinkedList split_after(size_t n) {
+        if (n >= count) return CircularLinkedList(get_allocator());
+
+        Node *first = head;
+        if (n <= count / 2) {
+            for (size_t i = 0; i < n; ++i) first = first->next;
+        } else {
+            for (size_t i = count; i > n; --i) first = first->prev;
+        }
+        return cut_before(first, n);
+    }
+
     Iterator begin() { return Iterator(head); }
     Iterator end() { return Iterator(head, true); }
+    ConstIterator begin() const { return ConstIterator(head); }
+    ConstIterator end() const { return ConstIterator(head, true); }
+    ConstIterator cbegin() const { return begin(); }
+    ConstIterator cend() const { return end(); }
 };
 
 #endif //CIRCULAR_LINKED_LIST_H
@@ -0,0 +1,353 @@
+﻿#ifndef COMPACT_XOR_LINKED_LIST_H
+#define COMPACT_XOR_LINKED_LIST_H
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// XOR linked list whose nodes live in one index-addressed slab and link
+// through a 32-bit XOR of neighbour indices instead of pointers. A node is
+// sizeof(T) rounded up with a uint32_t, so an int list needs 8 bytes per
+// element instead of a 16-byte heap block. Index 0 means "none"; slot i
+// is slab[i - 1]. Freed slots are reused through a free list threaded
+// through npx. Growing the slab relocates the values, which invalidates
+// iterators and references, but indices are position independent, so a
+// trivially copyable list can be copied byte for byte.
+template<typename T, typename Alloc = std::allocator<T> >
+class CompactXORLinkedList {
+public:
+    using Index = uint32_t;
+
+private:
+    struct Node {
+        alignas(T) unsigned char storage[sizeof(T)];
+        Index npx;
+
+        T *value() { return std::launder(reinterpret_cast<T *>(storage)); }
+        const T *value() const { return std::launder(reinterpret_cast<const T *>(storage)); }
+    };
+
+    using NodeAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAlloc>;
+
+    static constexpr size_t max_nodes = UINT32_MAX;
+
+    Node *slab = nullptr;
+    size_t slots = 0;
+    Index used = 0;
+    Index free_list = 0;
+    Index head = 0;
+    Index tail = 0;
+    size_t count = 0;
+    [[no_unique_address]] NodeAlloc alloc;
+
+    Node &at(Index i) { return slab[i - 1]; }
+    const Node &at(Index i) const { return slab[i - 1]; }
+
+    // Moves the live values into a slab of new_slots nodes; links and the
+    // free list are copied as they are since indices do not change.
+    void relocate(size_t new_slots) {
+        Node *fresh = NodeTraits::allocate(alloc, new_slots);
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (used) std::memcpy(static_cast<void *>(fresh), slab, used * sizeof(Node));
+        } else {
+            for (Index i = 0; i < used; ++i) fresh[i].npx = slab[i].npx;
+
+            Index prev = 0;
+            Index curr = head;
+            try {
+                while (curr) {
+                    std::construct_at(fresh[curr - 1].value(), std::move_if_noexcept(*at(curr).value()));
+                    Index next = prev ^ at(curr).npx;
+                    prev = curr;
+                    curr = next;
+                }
+            } catch (...) {
+                for (Index p = 0, c = head; c != curr;) {
+                    std::destroy_at(fresh[c - 1].value());
+                    Index next = p ^ at(c).npx;
+                    p = c;
+                    c = next;
+                }
+                NodeTraits::deallocate(alloc, fresh, new_slots);
+                throw;
+            }
+            destroy_values();
+        }
+        if (slab) NodeTraits::deallocate(alloc, slab, slots);
+        slab = fresh;
+        slots = new_slots;
+    }
+
+    Index acquire() {
+        if (free_list) {
+            Index i = free_list;
+            free_list = at(i).npx;
+            return i;
+        }
+        if (used == slots) {
+            if (slots == max_nodes) throw std::length_error("CompactXORLinkedList is full");
+            relocate(slots ? std::min(slots * 2, max_nodes) : 16);
+        }
+        return ++used;
+    }
+
+    void release_slot(Index i) {
+        at(i).npx = free_list;
+        free_list = i;
+    }
+
+    template<typename... Args>
+    void construct_in(Index i, Args &&... args) {
+        try {
+            std::construct_at(at(i).value(), std::forward<Args>(args)...);
+        } catch (...) {
+            release_slot(i);
+            throw;
+        }
+    }
+
+    template<typename... Args>
+    Index create_node(Args &&... args) {
+        if (!free_list && used == slots) {
+            // The arguments may refer into the slab that is about to move.
+            T value(std::forward<Args>(args)...);
+            Index i = acquire();
+            construct_in(i, std::move(value));
+            return i;
+        }
+        Index i = acquire();
+        construct_in(i, std::forward<Args>(args)...);
+        return i;
+    }
+
+    void destroy_node(Index i) {
+        std::destroy_at(at(i).value());
+        release_slot(i);
+    }
+
+    void destroy_values() {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (Index prev = 0, curr = head; curr;) {
+                Index next = prev ^ at(curr).npx;
+                std::destroy_at(at(curr).value());
+                prev = curr;
+                curr = next;
+            }
+        }
+    }
+
+    void unlink(Index prev, Index curr, Index next) {
+        if (prev) at(prev).npx ^= curr ^ next;
+        else head = next;
+        if (next) at(next).npx ^= curr ^ prev;
+        else tail = prev;
+    }
+
+public:
+    CompactXORLinkedList() = default;
+
+    explicit CompactXORLinkedList(const Alloc &a) : alloc(a) {
+    }
+
+    ~CompactXORLinkedList() {
+        destroy_values();
+        if (slab) NodeTraits::deallocate(alloc, slab, slots);
+    }
+
+    CompactXORLinkedList(const CompactXORLinkedList &) = delete;
+
+    CompactXORLinkedList &operator=(const CompactXORLinkedList &) = delete;
+
+    CompactXORLinkedList(CompactXORLinkedList &&other) noexcept
+        : slab(other.slab), slots(other.slots), used(other.used), free_list(other.free_list), head(other.head),
+          tail(other.tail), count(other.count), alloc(other.alloc) {
+        other.slab = nullptr;
+        other.slots = 0;
+        other.used = other.free_list = other.head = other.tail = 0;
+        other.count = 0;
+    }
+
+    CompactXORLinkedList &operator=(CompactXORLinkedList &&other) noexcept {
+        if (this != &other) {
+            destroy_values();
+            if (slab) NodeTraits::deallocate(alloc, slab, slots);
+            slab = other.slab;
+            slots = other.slots;
+            used = other.used;
+            free_list = other.free_list;
+            head = other.head;
+            tail = other.tail;
+            count = other.count;
+            alloc = other.alloc;
+            other.slab = nullptr;
+            other.slots = 0;
+            other.used = other.free_list = other.head = other.tail = 0;
+            other.count = 0;
+        }
+        return *this;
+    }
+
+    void push_front(const T &value) { emplace_front(value); }
+
+    void push_front(T &&value) { emplace_front(std::move(value)); }
+
+    template<typename... Args>
+    T &emplace_front(Args &&... args) {
+        Index node = create_node(std::forward<Args>(args)...);
+        at(node).npx = head;
+
+        if (head) {
+            at(head).npx ^= node;
+        } else {
+            tail = node;
+        }
+        head = node;
+        ++count;
+        return *at(node).value();
+    }
+
+    void push_back(const T &value) { emplace_back(value); }
+
+    void push_back(T &&value) { emplace_back(std::move(value)); }
+
+    template<typename... Args>
+    T &emplace_back(Args &&... args) {
+        Index node = create_node(std::forward<Args>(args)...);
+        at(node).npx = tail;
+
+        if (tail) {
+            at(tail).npx ^= node;
+        } else {
+            head = node;
+        }
+        tail = node;
+        ++count;
+        return *at(node).value();
+    }
+
+    T pop_front() {
+        if (!head) throw std::runtime_error("List is empty");
+
+        Index node = head;
+        T value = std::move(*at(node).value());
+        Index next = at(node).npx;
+
+        if (next) {
+            at(next).npx ^= node;
+        } else {
+            tail = 0;
+        }
+        head = next;
+        destroy_node(node);
+        --count;
+        return value;
+    }
+
+    T pop_back() {
+        if (!tail) throw std::runtime_error("List is empty");
+
+        Index node = tail;
+        T value = std::move(*at(node).value());
+        Index prev = at(node).npx;
+
+        if (prev) {
+            at(prev).npx ^= node;
+        } else {
+            head = 0;
+        }
+        tail = prev;
+        destroy_node(node);
+        --count;
+        return value;
+    }
+
+    T &front() {
+        if (!head) throw std::runtime_error("List is empty");
+        return *at(head).value();
+    }
+
+    T &back() {
+        if (!tail) throw std::runtime_error("List is empty");
+        return *at(tail).value();
+    }
+
+    bool contains(const T &value) const {
+        for (Index prev = 0, curr = head; curr;) {
+            if (*at(curr).value() == value) return true;
+            Index next = prev ^ at(curr).npx;
+            prev = curr;
+            curr = next;
+        }
+        return false;
+    }
+
+    bool remove(const T &value) {
+        for (Index prev = 0, curr = head; curr;) {
+            Index next = prev ^ at(curr).npx;
+            if (*at(curr).value() == value) {
+                unlink(prev, curr, next);
+                destroy_node(curr);
+                --count;
+                return true;
+            }
+            prev = curr;
+            curr = next;
+        }
+        return false;
+    }
+
+    // Destroys every value but keeps the slab for reuse.
+    void clear() {
+        destroy_values();
+        used = free_list = head = tail = 0;
+        count = 0;
+    }
+
+    // Grows the slab to hold n nodes without further relocation.
+    void reserve(size_t n) {
+        if (n > max_nodes) throw std::length_error("CompactXORLinkedList is full");
+        if (n > slots) relocate(n);
+    }
+
+    // Bytes held by the slab, including free and not yet used slots.
+    size_t memory_usage() const { return slots * sizeof(Node); }
+
+    Alloc get_allocator() const { return Alloc(alloc); }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    class Iterator {
+        Node *slab;
+        Index curr;
+        Index prev;
+
+    public:
+        Iterator(Node *s, Index c, Index p) : slab(s), curr(c), prev(p) {
+        }
+
+        T &operator*() { return *slab[curr - 1].value(); }
+
+        Iterator &operator++() {
+            Index next = prev ^ slab[curr - 1].npx;
+            prev = curr;
+            curr = next;
+            return *this;
+        }
+
+        bool operator!=(const Iterator &other) const {
+            return curr != other.curr;
+        }
+    };
+
+    Iterator begin() { return Iterator(slab, head, 0); }
+    Iterator end() { return Iterator(slab, 0, tail); }
+};
+
+#endif //COMPACT_XOR_LINKED_LIST_H
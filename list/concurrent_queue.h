@@ -0,0 +1,124 @@
+﻿#ifndef CONCURRENT_QUEUE_H
+#define CONCURRENT_QUEUE_H
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <utility>
+#include "../memory/hazard_pointers.h"
+
+// Unbounded multi-producer multi-consumer queue after Michael & Scott
+// (1996): a singly linked chain with a dummy head node, atomic head and
+// tail, and hazard pointers so dequeued nodes are never freed while another
+// thread may still read them.
+template<typename T>
+class ConcurrentQueue {
+private:
+    struct Node {
+        std::atomic<Node *> next{nullptr};
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T *value() { return std::launder(reinterpret_cast<T *>(storage)); }
+    };
+
+    static constexpr size_t cache_line = 64;
+
+    mutable HazardPointerDomain domain;
+    alignas(cache_line) std::atomic<Node *> head;
+    alignas(cache_line) std::atomic<Node *> tail;
+
+    static void delete_node(void *p) {
+        delete static_cast<Node *>(p);
+    }
+
+public:
+    ConcurrentQueue() {
+        Node *dummy = new Node;
+        head.store(dummy, std::memory_order_relaxed);
+        tail.store(dummy, std::memory_order_relaxed);
+    }
+
+    // Must not race with any other operation.
+    ~ConcurrentQueue() {
+        Node *node = head.load(std::memory_order_relaxed);
+        Node *next = node->next.load(std::memory_order_relaxed);
+        delete node;
+        while (next) {
+            node = next;
+            next = node->next.load(std::memory_order_relaxed);
+            std::destroy_at(node->value());
+            delete node;
+        }
+    }
+
+    ConcurrentQueue(const ConcurrentQueue &) = delete;
+
+    ConcurrentQueue &operator=(const ConcurrentQueue &) = delete;
+
+    void push_back(const T &value) { emplace_back(value); }
+
+    void push_back(T &&value) { emplace_back(std::move(value)); }
+
+    template<typename... Args>
+    void emplace_back(Args &&... args) {
+        Node *node = new Node;
+        try {
+            std::construct_at(node->value(), std::forward<Args>(args)...);
+        } catch (...) {
+            delete node;
+            throw;
+        }
+
+        HazardPointerDomain::Guard guard(domain);
+        while (true) {
+            Node *last = guard.protect(0, tail);
+            Node *next = last->next.load(std::memory_order_acquire);
+            if (last != tail.load(std::memory_order_acquire)) continue;
+
+            if (next) {
+                // Tail is lagging behind; help the other producer finish.
+                tail.compare_exchange_weak(last, next, std::memory_order_release, std::memory_order_relaxed);
+                continue;
+            }
+            if (last->next.compare_exchange_weak(next, node, std::memory_order_release, std::memory_order_relaxed)) {
+                tail.compare_exchange_strong(last, node, std::memory_order_release, std::memory_order_relaxed);
+                return;
+            }
+        }
+    }
+
+    // The node after the dummy becomes the new dummy; whoever swings head
+    // owns its value and moves it out.
+    std::optional<T> try_pop_front() {
+        HazardPointerDomain::Guard guard(domain);
+        while (true) {
+            Node *first = guard.protect(0, head);
+            Node *last = tail.load(std::memory_order_acquire);
+            Node *next = first->next.load(std::memory_order_acquire);
+            guard.set(1, next);
+            if (first != head.load(std::memory_order_seq_cst)) continue;
+
+            if (!next) return std::nullopt;
+            if (first == last) {
+                tail.compare_exchange_weak(last, next, std::memory_order_release, std::memory_order_relaxed);
+                continue;
+            }
+            if (head.compare_exchange_strong(first, next, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                std::optional<T> value(std::move(*next->value()));
+                std::destroy_at(next->value());
+                guard.clear();
+                guard.retire(first, &delete_node);
+                return value;
+            }
+        }
+    }
+
+    // A snapshot only: other threads may change it before the caller looks.
+    bool empty() const {
+        HazardPointerDomain::Guard guard(domain);
+        return guard.protect(0, head)->next.load(std::memory_order_acquire) == nullptr;
+    }
+};
+
+#endif //CONCURRENT_QUEUE_H
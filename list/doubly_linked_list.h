@@ -1,26 +1,247 @@
 ﻿#ifndef DOUBLY_LINKED_LIST_H
 #define DOUBLY_LINKED_LIST_H
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <ranges>
 #include <stdexcept>
-
-template<typename T>
+#include <type_traits>
+#include <utility>
+#include "../algorithm/parallel_sort.cpp"
+#include "../algorithm/prefetch.h"
+#include "../algorithm/traits.h"
+#include "../memory/inline_slots.h"
+#include "../memory/node_blocks.h"
+#include "list_stats.h"
+
+// Inline > 0 reserves room for that many nodes inside the list object; see
+// SinglyLinkedList, which works the same way.
+template<typename T, typename Alloc = std::allocator<T>, typename Prefetch = NoPrefetch, typename Stats = NoStats,
+    size_t Inline = 0>
 class DoublyLinkedList {
+    static_assert(Inline == 0 || std::is_nothrow_move_constructible_v<T>,
+                  "inline nodes need a nothrow move constructor");
+
 private:
     struct Node {
         T data;
         Node *prev;
         Node *next;
+        [[no_unique_address]] JumpLink<Node, prefetch_enabled_v<Prefetch> > link;
 
-        Node(const T &val) : data(val), prev(nullptr), next(nullptr) {
+        template<typename... Args>
+        explicit Node(Args &&... args) : data(std::forward<Args>(args)...), prev(nullptr), next(nullptr) {
         }
     };
 
+    using NodeAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAlloc>;
+
     Node *head = nullptr;
     Node *tail = nullptr;
     size_t count = 0;
+    [[no_unique_address]] NodeAlloc alloc;
+    NodeBlocks<Node, NodeAlloc> blocks;
+    [[no_unique_address]] mutable Stats recorder;
+    [[no_unique_address]] InlineSlots<Node, Inline> slots;
+
+    template<typename... Args>
+    Node *create_node(Args &&... args) {
+        Node *node = slots.allocate();
+        if (!node) node = NodeTraits::allocate(alloc, 1);
+        try {
+            NodeTraits::construct(alloc, node, std::forward<Args>(args)...);
+        } catch (...) {
+            if (slots.owns(node)) slots.release(node);
+            else NodeTraits::deallocate(alloc, node, 1);
+            throw;
+        }
+        recorder.on_allocate();
+        return node;
+    }
+
+    void destroy_node(Node *node) {
+        NodeTraits::destroy(alloc, node);
+        recorder.on_free();
+        if (slots.owns(node)) slots.release(node);
+        else if (!blocks.release(alloc, node)) NodeTraits::deallocate(alloc, node, 1);
+    }
+
+    // Destroys a chain of already unlinked nodes, linked through next.
+    void free_chain(Node *node) {
+        while (node) {
+            Node *next = node->next;
+            destroy_node(node);
+            node = next;
+        }
+    }
+
+    size_t reserve_spares(size_t moving, Node **spare) {
+        size_t need = moving > slots.available() ? moving - slots.available() : 0;
+        size_t got = 0;
+        try {
+            for (; got < need; ++got) spare[got] = NodeTraits::allocate(alloc, 1);
+        } catch (...) {
+            while (got) NodeTraits::deallocate(alloc, spare[--got], 1);
+            throw;
+        }
+        return need;
+    }
+
+    // Rehomes the nodes of first..last that live in `from`: each is moved
+    // into a free slot of ours, else into the next spare, and both of its
+    // neighbours are repointed.
+    void relocate_inline(Node *&first, Node *&last, InlineSlots<Node, Inline> &from, Node **spare) noexcept {
+        size_t left = from.live();
+        for (Node *curr = first; curr && left; curr = curr->next) {
+            if (!from.owns(curr)) continue;
+            Node *node = slots.allocate();
+            if (!node) node = *spare++;
+            NodeTraits::construct(alloc, node, std::move(curr->data));
+            node->prev = curr->prev;
+            node->next = curr->next;
+            if (node->prev) node->prev->next = node;
+            else first = node;
+            if (node->next) node->next->prev = node;
+            if (curr == last) last = node;
+            NodeTraits::destroy(alloc, curr);
+            from.release(curr);
+            curr = node;
+            --left;
+        }
+    }
+
+    // Called at the end of push, pop and remove. Compaction is best effort
+    // here: if it throws, the list is unchanged and the exception dropped.
+    void maybe_compact() {
+        if (!blocks.due(count) || fragmentation() <= blocks.threshold()) return;
+        try {
+            compact();
+        } catch (...) {
+        }
+    }
+
+    // Moves all of other's nodes in before next, or at the back when next is
+    // null. Nodes change owner, so both lists must share an allocator.
+    void link_before(Node *next, DoublyLinkedList &other) {
+        if (this == &other || !other.head) return;
+        if (!(alloc == other.alloc)) throw std::invalid_argument("Lists use different allocators");
+        if constexpr (Inline > 0) {
+            Node *spare[Inline];
+            size_t spares = reserve_spares(other.slots.live(), spare);
+            try {
+                blocks.take(other.blocks);
+            } catch (...) {
+                while (spares) NodeTraits::deallocate(alloc, spare[--spares], 1);
+                throw;
+            }
+            relocate_inline(other.head, other.tail, other.slots, spare);
+        } else {
+            blocks.take(other.blocks);
+        }
+
+        Node *prev = next ? next->prev : tail;
+        other.head->prev = prev;
+        other.tail->next = next;
+        if (prev) prev->next = other.head;
+        else head = other.head;
+        if (next) next->prev = other.tail;
+        else tail = other.tail;
+        count += other.count;
+
+        other.head = other.tail = nullptr;
+        other.count = 0;
+    }
+
+    // Detaches first and everything after it into a new list; `kept` is how
+    // many nodes stay behind.
+    DoublyLinkedList cut_before(Node *first, size_t kept) {
+        DoublyLinkedList rest(get_allocator());
+        if (!first) return rest;
+
+        rest.blocks.share(blocks);
+        Node *prev = first->prev;
+        rest.head = first;
+        rest.tail = tail;
+        rest.count = count - kept;
+        first->prev = nullptr;
+        if (prev) prev->next = nullptr;
+        else head = nullptr;
+        tail = prev;
+        count = kept;
+        if constexpr (Inline > 0) rest.relocate_inline(rest.head, rest.tail, slots, nullptr);
+        return rest;
+    }
+
+    bool release_nodes() {
+        if constexpr (has_release_v<NodeAlloc> && std::is_trivially_destructible_v<T>) {
+            if (alloc.live() == count && blocks.empty() && slots.empty()) {
+                recorder.on_free(count);
+                alloc.release();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Copies [first, last) into a detached list in a single linking pass;
+    // tail and count are written once at the end. Its nodes may sit in our
+    // inline slots, so on failure we free them rather than the chain.
+    template<typename It, typename S>
+    DoublyLinkedList chain_of(It first, S last) {
+        DoublyLinkedList chain(get_allocator());
+        Node *prev = nullptr;
+        size_t n = 0;
+        try {
+            for (; first != last; ++first, ++n) {
+                Node *node = create_node(*first);
+                node->prev = prev;
+                if (prev) prev->next = node;
+                else chain.head = node;
+                prev = node;
+            }
+        } catch (...) {
+            while (Node *node = chain.head) {
+                chain.head = node->next;
+                destroy_node(node);
+            }
+            throw;
+        }
+        chain.tail = prev;
+        chain.count = n;
+        return chain;
+    }
+
+    void append_chain(DoublyLinkedList &&chain) { link_before(nullptr, chain); }
 
 public:
+    using value_type = T;
+    using reference = T &;
+    using const_reference = const T &;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using allocator_type = Alloc;
+
     DoublyLinkedList() = default;
 
+    explicit DoublyLinkedList(const Alloc &a) : alloc(a) {
+    }
+
+    template<std::input_iterator It, std::sentinel_for<It> S>
+    DoublyLinkedList(It first, S last, const Alloc &a = Alloc()) : alloc(a) {
+        append_chain(chain_of(std::move(first), std::move(last)));
+    }
+
+    // Builds a list from any input range, reading it exactly once, so
+    // generators and istream views need no intermediate buffer.
+    template<std::ranges::input_range R>
+    static DoublyLinkedList from_stream(R &&input, const Alloc &a = Alloc()) {
+        DoublyLinkedList list(a);
+        list.append_range(std::forward<R>(input));
+        return list;
+    }
+
     ~DoublyLinkedList() { clear(); }
 
     DoublyLinkedList(const DoublyLinkedList &) = delete;
@@ -28,7 +249,9 @@ public:
     DoublyLinkedList &operator=(const DoublyLinkedList &) = delete;
 
     DoublyLinkedList(DoublyLinkedList &&other) noexcept
-        : head(other.head), tail(other.tail), count(other.count) {
+        : head(other.head), tail(other.tail), count(other.count), alloc(other.alloc),
+          blocks(std::move(other.blocks)) {
+        if constexpr (Inline > 0) relocate_inline(head, tail, other.slots, nullptr);
         other.head = other.tail = nullptr;
         other.count = 0;
     }
@@ -39,51 +262,74 @@ public:
             head = other.head;
             tail = other.tail;
             count = other.count;
+            alloc = other.alloc;
+            blocks = std::move(other.blocks);
+            if constexpr (Inline > 0) relocate_inline(head, tail, other.slots, nullptr);
             other.head = other.tail = nullptr;
             other.count = 0;
         }
         return *this;
     }
 
-    void push_front(const T &value) {
-        Node *node = new Node(value);
+    void push_front(const T &value) { emplace_front(value); }
+
+    void push_front(T &&value) { emplace_front(std::move(value)); }
+
+    template<typename... Args>
+    T &emplace_front(Args &&... args) {
+        Node *node = create_node(std::forward<Args>(args)...);
         node->next = head;
         if (head) head->prev = node;
         else tail = node;
         head = node;
         ++count;
+        recorder.on_push();
+        maybe_compact();
+        return head->data;
     }
 
-    void push_back(const T &value) {
-        Node *node = new Node(value);
+    void push_back(const T &value) { emplace_back(value); }
+
+    void push_back(T &&value) { emplace_back(std::move(value)); }
+
+    template<typename... Args>
+    T &emplace_back(Args &&... args) {
+        Node *node = create_node(std::forward<Args>(args)...);
         node->prev = tail;
         if (tail) tail->next = node;
         else head = node;
         tail = node;
         ++count;
+        recorder.on_push();
+        maybe_compact();
+        return tail->data;
     }
 
     T pop_front() {
         if (!head) throw std::runtime_error("List is empty");
         Node *node = head;
-        T value = node->data;
+        T value = std::move(node->data);
         head = head->next;
         if (head) head->prev = nullptr;
         else tail = nullptr;
-        delete node;
+        destroy_node(node);
         --count;
+        recorder.on_pop();
+        maybe_compact();
         return value;
     }
 
     T pop_back() {
         if (!tail) throw std::runtime_error("List is empty");
         Node *node = tail;
-        T value = node->data;
+        T value = std::move(node->data);
         tail = tail->prev;
         if (tail) tail->next = nullptr;
         else head = nullptr;
-        delete node;
+        destroy_node(node);
         --count;
+        recorder.on_pop();
+        maybe_compact();
         return value;
     }
 
@@ -98,64 +344,238 @@ public:
     }
 
     bool contains(const T &value) const {
+        JumpWindow<Node, Prefetch> window;
+        size_t visited = 0;
         for (Node *curr = head; curr; curr = curr->next) {
-            if (curr->data == value) return true;
+            window.visit(curr);
+            ++visited;
+            if (curr->data == value) {
+                recorder.on_contains(visited);
+                return true;
+            }
         }
+        recorder.on_contains(visited);
         return false;
     }
 
     bool remove(const T &value) {
+        JumpWindow<Node, Prefetch> window;
+        size_t visited = 0;
         for (Node *curr = head; curr; curr = curr->next) {
+            window.visit(curr);
+            ++visited;
             if (curr->data == value) {
+                recorder.on_remove(visited);
                 if (curr->prev) curr->prev->next = curr->next;
                 else head = curr->next;
 
                 if (curr->next) curr->next->prev = curr->prev;
                 else tail = curr->prev;
 
-                delete curr;
+                destroy_node(curr);
                 --count;
+                maybe_compact();
                 return true;
             }
         }
+        recorder.on_remove(visited);
         return false;
     }
 
+    // One pass over the list removing every element for which pred holds;
+    // returns the count. Unlinked nodes are set aside and freed as a batch
+    // at the end, also when pred throws.
+    template<typename Pred>
+    size_t remove_if(Pred pred) {
+        JumpWindow<Node, Prefetch> window;
+        Node *dead = nullptr;
+        size_t removed = 0;
+        try {
+            for (Node *curr = head, *next; curr; curr = next) {
+                window.visit(curr);
+                next = curr->next;
+                if (!pred(curr->data)) continue;
+                if (curr->prev) curr->prev->next = next;
+                else head = next;
+                if (next) next->prev = curr->prev;
+                else tail = curr->prev;
+                curr->next = dead;
+                dead = curr;
+                --count;
+                ++removed;
+            }
+        } catch (...) {
+            free_chain(dead);
+            throw;
+        }
+        free_chain(dead);
+        if (removed) maybe_compact();
+        return removed;
+    }
+
+    size_t remove_all(const T &value) {
+        return remove_if([&value](const T &x) { return x == value; });
+    }
+
+    // Keeps the first of every run of equal neighbours, so a sorted list
+    // ends up with each value once. Returns the number removed.
+    template<typename Eq = std::equal_to<> >
+    size_t unique(Eq eq = {}) {
+        const T *kept = nullptr;
+        return remove_if([&](const T &x) {
+            if (kept && eq(*kept, x)) return true;
+            kept = &x;
+            return false;
+        });
+    }
+
+    // Removes every element contained in values, a std::set, an
+    // unordered_set or anything else with contains().
+    template<typename Set>
+        requires requires(const Set &s, const T &v) { { s.contains(v) } -> std::convertible_to<bool>; }
+    size_t erase(const Set &values) {
+        return remove_if([&values](const T &x) { return values.contains(x); });
+    }
+
     void clear() {
+        if (release_nodes()) {
+            head = nullptr;
+        }
         while (head) {
             Node *tmp = head;
+            JumpWindow<Node, Prefetch>::follow(tmp);
             head = head->next;
-            delete tmp;
+            destroy_node(tmp);
         }
         tail = nullptr;
         count = 0;
+        blocks.reset();
+    }
+
+    // Moves the elements into one new array of nodes, in list order, and
+    // relinks them, undoing the scatter that long churn leaves behind.
+    // Invalidates iterators and references. Values are copied only if
+    // moving T can throw; a failure then leaves the list unchanged.
+    void compact() {
+        if (!head) return;
+        Node *fresh = blocks.allocate(alloc, count);
+        size_t built = 0;
+        try {
+            for (Node *curr = head; curr; curr = curr->next) {
+                NodeTraits::construct(alloc, fresh + built, std::move_if_noexcept(curr->data));
+                // Park the old node in the new one until the second pass.
+                fresh[built++].next = curr;
+            }
+        } catch (...) {
+            while (built) NodeTraits::destroy(alloc, fresh + --built);
+            blocks.abandon(alloc, fresh);
+            throw;
+        }
+        recorder.on_compact();
+        recorder.on_allocate(count);
+        for (size_t i = 0; i < count; ++i) {
+            destroy_node(fresh[i].next);
+            fresh[i].next = i + 1 < count ? fresh + i + 1 : nullptr;
+            fresh[i].prev = i ? fresh + i - 1 : nullptr;
+        }
+        head = fresh;
+        tail = fresh + count - 1;
+    }
+
+    // Share of next links, from 0 to 1, that lead more than a few cache
+    // lines away. Walks the whole list.
+    double fragmentation() const {
+        if (count < 2) return 0;
+        size_t far = 0;
+        for (Node *curr = head; curr->next; curr = curr->next) far += nodes_far_apart(curr, curr->next);
+        return static_cast<double>(far) / static_cast<double>(count - 1);
     }
 
+    // With a threshold above 0, push, pop and remove compact the list once
+    // fragmentation() exceeds it. The check walks the list, so it only runs
+    // after about size() such operations; any of them may then invalidate
+    // iterators.
+    void set_compaction_threshold(double fraction) { blocks.set_threshold(fraction); }
+
+    Stats stats() const { return recorder; }
+
+    void reset_stats() { recorder = Stats(); }
+
+    template<typename Compare = std::less<> >
+    void sort(Compare comp = {}) {
+        head = merge_sort(head, comp, &tail);
+    }
+
+    // Sorts on several threads; see parallel_merge_sort for the options.
+    template<typename Compare = std::less<> >
+    void parallel_sort(Compare comp = {}, ParallelSortOptions options = {}) {
+        options.length = count;
+        head = parallel_merge_sort(head, comp, options, &tail);
+    }
+
+    Alloc get_allocator() const { return Alloc(alloc); }
+
     size_t size() const { return count; }
     bool empty() const { return count == 0; }
 
-    class Iterator {
-        Node *curr;
+    template<bool Const>
+    class BasicIterator {
+        Node *curr = nullptr;
+        const DoublyLinkedList *list = nullptr;
+
+        friend class DoublyLinkedList;
+        friend class BasicIterator<!Const>;
 
     public:
-        Iterator(Node *n) : curr(n) {
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T *, T *>;
+        using reference = std::conditional_t<Const, const T &, T &>;
+
+        BasicIterator() = default;
+
+        BasicIterator(Node *n, const DoublyLinkedList *l) : curr(n), list(l) {
         }
 
-        T &operator*() { return curr->data; }
+        template<bool C = Const> requires C
+        BasicIterator(const BasicIterator<false> &o) : curr(o.curr), list(o.list) {
+        }
+
+        reference operator*() const { return curr->data; }
+        pointer operator->() const { return &curr->data; }
 
-        Iterator &operator++() {
+        BasicIterator &operator++() {
             curr = curr->next;
             return *this;
         }
 
-        Iterator &operator--() {
-            curr = curr->prev;
+        BasicIterator operator++(int) {
+            BasicIterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        // Decrementing end() gives the last element.
+        BasicIterator &operator--() {
+            curr = curr ? curr->prev : list->tail;
             return *this;
         }
 
-        bool operator!=(const Iterator &o) const { return curr != o.curr; }
+        BasicIterator operator--(int) {
+            BasicIterator old = *this;
+            --*this;
+            return old;
+        }
+
+        bool operator==(const BasicIterator &o) const { return curr == o.curr; }
     };
 
+    using Iterator = BasicIterator<false>;
+    using ConstIterator = BasicIterator<true>;
+    using iterator = Iterator;
+    using const_iterator = ConstIterator;
+
     class ReverseIterator {
         Node *curr;
 
@@ -173,11 +593,90 @@ public:
         bool operator!=(const ReverseIterator &o) const { return curr != o.curr; }
     };
 
-    Iterator begin() { return Iterator(head); }
-    Iterator end() { return Iterator(nullptr); }
+    // Inserts other's elements before pos without allocating. O(1).
+    void splice(Iterator pos, DoublyLinkedList &other) { link_before(pos.curr, other); }
+
+    void append(DoublyLinkedList &&other) { link_before(nullptr, other); }
+
+    // Replaces the contents. The new nodes are built before the old ones
+    // are freed, so a throwing element constructor leaves the list intact.
+    template<std::input_iterator It, std::sentinel_for<It> S>
+    void assign(It first, S last) {
+        DoublyLinkedList chain = chain_of(std::move(first), std::move(last));
+        clear();
+        append_chain(std::move(chain));
+    }
+
+    template<std::ranges::input_range R>
+    void assign_range(R &&range) { assign(std::ranges::begin(range), std::ranges::end(range)); }
+
+    // The *_range members link the new nodes in one pass and update the
+    // size once.
+    template<std::ranges::input_range R>
+    void append_range(R &&range) { append_chain(chain_of(std::ranges::begin(range), std::ranges::end(range))); }
+
+    template<std::ranges::input_range R>
+    void prepend_range(R &&range) {
+        DoublyLinkedList chain = chain_of(std::ranges::begin(range), std::ranges::end(range));
+        link_before(head, chain);
+    }
+
+    // Inserts the range before pos.
+    template<std::ranges::input_range R>
+    void insert_range(Iterator pos, R &&range) {
+        DoublyLinkedList chain = chain_of(std::ranges::begin(range), std::ranges::end(range));
+        splice(pos, chain);
+    }
+
+    // Keeps [begin, pos) and returns [pos, end). The relink is O(1); finding
+    // the new sizes walks in from both ends, so it costs the shorter side.
+    DoublyLinkedList split_at(Iterator pos) {
+        if (!pos.curr) return DoublyLinkedList(get_allocator());
+
+        Node *fwd = head;
+        Node *bwd = tail;
+        size_t kept = 0;
+        for (size_t step = 0;; ++step, fwd = fwd->next, bwd = bwd->prev) {
+            if (fwd == pos.curr) {
+                kept = step;
+                break;
+            }
+            if (bwd == pos.curr) {
+                kept = count - step - 1;
+                break;
+            }
+        }
+        return cut_before(pos.curr, kept);
+    }
+
+    // Keeps the first n elements and returns the rest, walking from
+    // whichever end is closer to the cut.
+    DoublyLinkedList split_after(size_t n) {
+        if (n >= count) return DoublyLinkedList(get_allocator());
+
+        Node *first;
+        if (n <= count / 2) {
+            first = head;
+            for (size_t i = 0; i < n; ++i) first = first->next;
+        } else {
+            first = tail;
+            for (size_t i = count - 1; i > n; --i) first = first->prev;
+        }
+        return cut_before(first, n);
+    }
+
+    Iterator begin() { return Iterator(head, this); }
+    Iterator end() { return Iterator(nullptr, this); }
+    ConstIterator begin() const { return ConstIterator(head, this); }
+    ConstIterator end() const { return ConstIterator(nullptr, this); }
+    ConstIterator cbegin() const { return begin(); }
+    ConstIterator cend() const { return end(); }
     ReverseIterator rbegin() { return ReverseIterator(tail); }
     ReverseIterator rend() { return ReverseIterator(nullptr); }
 };
 
+template<typename T, size_t N, typename Alloc = std::allocator<T> >
+using SmallDoublyLinkedList = DoublyLinkedList<T, Alloc, NoPrefetch, NoStats, N>;
+
 
 #endif //DOUBLY_LINKED_LIST_H
@@ -0,0 +1,192 @@
+﻿#ifndef INTRUSIVE_CIRCULAR_LINKED_LIST_H
+#define INTRUSIVE_CIRCULAR_LINKED_LIST_H
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include "../algorithm/sort.cpp"
+#include "../algorithm/traits.h"
+
+// Ring of objects that derive from IntrusiveDoublyHook<T>. The list never
+// allocates or destroys elements; an object can be unlinked in O(1).
+template<typename T>
+class IntrusiveCircularLinkedList {
+    static_assert(std::is_base_of_v<IntrusiveDoublyHook<T>, T>,
+                  "T must derive from IntrusiveDoublyHook<T>");
+
+private:
+    T *head = nullptr;
+    size_t count = 0;
+
+    // Links obj in just before next, i.e. at the back when next is head.
+    void link_before(T *next, T &obj) {
+        if (!next) {
+            obj.prev = obj.next = &obj;
+            head = &obj;
+        } else {
+            obj.next = next;
+            obj.prev = next->prev;
+            next->prev->next = &obj;
+            next->prev = &obj;
+        }
+        ++count;
+    }
+
+    void unlink(T *node) {
+        if (count == 1) {
+            head = nullptr;
+        } else {
+            node->prev->next = node->next;
+            node->next->prev = node->prev;
+            if (node == head) head = node->next;
+        }
+        node->prev = node->next = nullptr;
+        --count;
+    }
+
+public:
+    IntrusiveCircularLinkedList() = default;
+
+    ~IntrusiveCircularLinkedList() { clear(); }
+
+    IntrusiveCircularLinkedList(const IntrusiveCircularLinkedList &) = delete;
+
+    IntrusiveCircularLinkedList &operator=(const IntrusiveCircularLinkedList &) = delete;
+
+    IntrusiveCircularLinkedList(IntrusiveCircularLinkedList &&other) noexcept
+        : head(other.head), count(other.count) {
+        other.head = nullptr;
+        other.count = 0;
+    }
+
+    IntrusiveCircularLinkedList &operator=(IntrusiveCircularLinkedList &&other) noexcept {
+        if (this != &other) {
+            clear();
+            head = other.head;
+            count = other.count;
+            other.head = nullptr;
+            other.count = 0;
+        }
+        return *this;
+    }
+
+    void push_front(T &obj) {
+        link_before(head, obj);
+        head = &obj;
+    }
+
+    void push_back(T &obj) { link_before(head, obj); }
+
+    T &pop_front() {
+        if (!head) throw std::runtime_error("List is empty");
+        T *node = head;
+        unlink(node);
+        return *node;
+    }
+
+    T &pop_back() {
+        if (!head) throw std::runtime_error("List is empty");
+        T *node = head->prev;
+        unlink(node);
+        return *node;
+    }
+
+    T &front() {
+        if (!head) throw std::runtime_error("List is empty");
+        return *head;
+    }
+
+    T &back() {
+        if (!head) throw std::runtime_error("List is empty");
+        return *head->prev;
+    }
+
+    void rotate_forward() {
+        if (head) head = head->next;
+    }
+
+    void rotate_backward() {
+        if (head) head = head->prev;
+    }
+
+    // Unlinks an object that is in this list. O(1).
+    void erase(T &obj) { unlink(&obj); }
+
+    bool contains(const T &value) const {
+        if (!head) return false;
+        T *curr = head;
+        do {
+            if (*curr == value) return true;
+            curr = curr->next;
+        } while (curr != head);
+        return false;
+    }
+
+    bool remove(const T &value) {
+        if (!head) return false;
+        T *curr = head;
+        do {
+            if (*curr == value) {
+                unlink(curr);
+                return true;
+            }
+            curr = curr->next;
+        } while (curr != head);
+        return false;
+    }
+
+    void clear() {
+        if (!head) return;
+        T *curr = head;
+        do {
+            T *tmp = curr;
+            curr = curr->next;
+            tmp->prev = tmp->next = nullptr;
+        } while (curr != head);
+        head = nullptr;
+        count = 0;
+    }
+
+    // Opens the ring, sorts it as a null-terminated chain and closes it again.
+    template<typename Compare = std::less<> >
+    void sort(Compare comp = {}) {
+        if (count < 2) return;
+        head->prev->next = nullptr;
+        head->prev = nullptr;
+        T *last = nullptr;
+        head = merge_sort(head, comp, &last);
+        last->next = head;
+        head->prev = last;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    class Iterator {
+        T *curr;
+        T *start;
+        bool done;
+
+    public:
+        Iterator(T *n, bool end = false)
+            : curr(n), start(n), done(end || !n) {
+        }
+
+        T &operator*() { return *curr; }
+
+        Iterator &operator++() {
+            curr = curr->next;
+            if (curr == start) done = true;
+            return *this;
+        }
+
+        bool operator!=(const Iterator &o) const {
+            return !done || !o.done;
+        }
+    };
+
+    Iterator begin() { return Iterator(head); }
+    Iterator end() { return Iterator(head, true); }
+};
+
+#endif //INTRUSIVE_CIRCULAR_LINKED_LIST_H
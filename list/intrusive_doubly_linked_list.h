@@ -0,0 +1,207 @@
+﻿#ifndef INTRUSIVE_DOUBLY_LINKED_LIST_H
+#define INTRUSIVE_DOUBLY_LINKED_LIST_H
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include "../algorithm/sort.cpp"
+#include "../algorithm/traits.h"
+
+// Doubly linked list over objects that derive from IntrusiveDoublyHook<T>.
+// The list never allocates or destroys elements; it only links the objects
+// it is given, so they must outlive their membership.
+template<typename T>
+class IntrusiveDoublyLinkedList {
+    static_assert(std::is_base_of_v<IntrusiveDoublyHook<T>, T>,
+                  "T must derive from IntrusiveDoublyHook<T>");
+
+private:
+    T *head = nullptr;
+    T *tail = nullptr;
+    size_t count = 0;
+
+    void unlink(T *node) {
+        if (node->prev) node->prev->next = node->next;
+        else head = node->next;
+
+        if (node->next) node->next->prev = node->prev;
+        else tail = node->prev;
+
+        node->prev = node->next = nullptr;
+        --count;
+    }
+
+public:
+    IntrusiveDoublyLinkedList() = default;
+
+    ~IntrusiveDoublyLinkedList() { clear(); }
+
+    IntrusiveDoublyLinkedList(const IntrusiveDoublyLinkedList &) = delete;
+
+    IntrusiveDoublyLinkedList &operator=(const IntrusiveDoublyLinkedList &) = delete;
+
+    IntrusiveDoublyLinkedList(IntrusiveDoublyLinkedList &&other) noexcept
+        : head(other.head), tail(other.tail), count(other.count) {
+        other.head = other.tail = nullptr;
+        other.count = 0;
+    }
+
+    IntrusiveDoublyLinkedList &operator=(IntrusiveDoublyLinkedList &&other) noexcept {
+        if (this != &other) {
+            clear();
+            head = other.head;
+            tail = other.tail;
+            count = other.count;
+            other.head = other.tail = nullptr;
+            other.count = 0;
+        }
+        return *this;
+    }
+
+    void push_front(T &obj) {
+        obj.prev = nullptr;
+        obj.next = head;
+        if (head) head->prev = &obj;
+        else tail = &obj;
+        head = &obj;
+        ++count;
+    }
+
+    void push_back(T &obj) {
+        obj.next = nullptr;
+        obj.prev = tail;
+        if (tail) tail->next = &obj;
+        else head = &obj;
+        tail = &obj;
+        ++count;
+    }
+
+    T &pop_front() {
+        if (!head) throw std::runtime_error("List is empty");
+        T *node = head;
+        unlink(node);
+        return *node;
+    }
+
+    T &pop_back() {
+        if (!tail) throw std::runtime_error("List is empty");
+        T *node = tail;
+        unlink(node);
+        return *node;
+    }
+
+    T &front() {
+        if (!head) throw std::runtime_error("List is empty");
+        return *head;
+    }
+
+    T &back() {
+        if (!tail) throw std::runtime_error("List is empty");
+        return *tail;
+    }
+
+    // Unlinks an object that is in this list. O(1).
+    void erase(T &obj) { unlink(&obj); }
+
+    bool contains(const T &value) const {
+        for (T *curr = head; curr; curr = curr->next) {
+            if (*curr == value) return true;
+        }
+        return false;
+    }
+
+    bool remove(const T &value) {
+        for (T *curr = head; curr; curr = curr->next) {
+            if (*curr == value) {
+                unlink(curr);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Unlinks every object; nothing is destroyed.
+    void clear() {
+        while (head) {
+            T *tmp = head;
+            head = head->next;
+            tmp->prev = tmp->next = nullptr;
+        }
+        tail = nullptr;
+        count = 0;
+    }
+
+    template<typename Compare = std::less<> >
+    void sort(Compare comp = {}) {
+        head = merge_sort(head, comp, &tail);
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    class Iterator {
+        T *curr;
+
+        friend class IntrusiveDoublyLinkedList;
+
+    public:
+        Iterator(T *n) : curr(n) {
+        }
+
+        T &operator*() { return *curr; }
+
+        Iterator &operator++() {
+            curr = curr->next;
+            return *this;
+        }
+
+        Iterator &operator--() {
+            curr = curr->prev;
+            return *this;
+        }
+
+        bool operator!=(const Iterator &o) const { return curr != o.curr; }
+    };
+
+    class ReverseIterator {
+        T *curr;
+
+    public:
+        ReverseIterator(T *n) : curr(n) {
+        }
+
+        T &operator*() { return *curr; }
+
+        ReverseIterator &operator++() {
+            curr = curr->prev;
+            return *this;
+        }
+
+        bool operator!=(const ReverseIterator &o) const { return curr != o.curr; }
+    };
+
+    // Links obj in before pos. O(1).
+    Iterator insert(Iterator pos, T &obj) {
+        if (!pos.curr) {
+            push_back(obj);
+        } else if (pos.curr == head) {
+            push_front(obj);
+        } else {
+            obj.prev = pos.curr->prev;
+            obj.next = pos.curr;
+            pos.curr->prev->next = &obj;
+            pos.curr->prev = &obj;
+            ++count;
+        }
+        return Iterator(&obj);
+    }
+
+    Iterator iterator_to(T &obj) { return Iterator(&obj); }
+
+    Iterator begin() { return Iterator(head); }
+    Iterator end() { return Iterator(nullptr); }
+    ReverseIterator rbegin() { return ReverseIterator(tail); }
+    ReverseIterator rend() { return ReverseIterator(nullptr); }
+};
+
+#endif //INTRUSIVE_DOUBLY_LINKED_LIST_H
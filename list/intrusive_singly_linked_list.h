@@ -0,0 +1,174 @@
+﻿#ifndef INTRUSIVE_SINGLY_LINKED_LIST_H
+#define INTRUSIVE_SINGLY_LINKED_LIST_H
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include "../algorithm/sort.cpp"
+#include "../algorithm/traits.h"
+
+// Singly linked list over objects that derive from IntrusiveSinglyHook<T>.
+// The list never allocates or destroys elements. Without a back link,
+// unlinking an arbitrary object is O(n); use IntrusiveDoublyLinkedList when
+// that has to be O(1).
+template<typename T>
+class IntrusiveSinglyLinkedList {
+    static_assert(std::is_base_of_v<IntrusiveSinglyHook<T>, T>,
+                  "T must derive from IntrusiveSinglyHook<T>");
+
+    T *head = nullptr;
+    T *tail = nullptr;
+    size_t count = 0;
+
+    void unlink_after(T *prev, T *node) {
+        if (prev) prev->next = node->next;
+        else head = node->next;
+        if (node == tail) tail = prev;
+        node->next = nullptr;
+        --count;
+    }
+
+public:
+    IntrusiveSinglyLinkedList() = default;
+
+    ~IntrusiveSinglyLinkedList() { clear(); }
+
+    IntrusiveSinglyLinkedList(const IntrusiveSinglyLinkedList &) = delete;
+
+    IntrusiveSinglyLinkedList &operator=(const IntrusiveSinglyLinkedList &) = delete;
+
+    IntrusiveSinglyLinkedList(IntrusiveSinglyLinkedList &&other) noexcept
+        : head(other.head), tail(other.tail), count(other.count) {
+        other.head = other.tail = nullptr;
+        other.count = 0;
+    }
+
+    IntrusiveSinglyLinkedList &operator=(IntrusiveSinglyLinkedList &&other) noexcept {
+        if (this != &other) {
+            clear();
+            head = other.head;
+            tail = other.tail;
+            count = other.count;
+            other.head = other.tail = nullptr;
+            other.count = 0;
+        }
+        return *this;
+    }
+
+    void push_front(T &obj) {
+        obj.next = head;
+        head = &obj;
+        if (!tail) tail = &obj;
+        ++count;
+    }
+
+    void push_back(T &obj) {
+        obj.next = nullptr;
+        if (tail) {
+            tail->next = &obj;
+        } else {
+            head = &obj;
+        }
+        tail = &obj;
+        ++count;
+    }
+
+    T &pop_front() {
+        if (!head) throw std::runtime_error("List is empty");
+        T *node = head;
+        unlink_after(nullptr, node);
+        return *node;
+    }
+
+    T &front() {
+        if (!head) throw std::runtime_error("List is empty");
+        return *head;
+    }
+
+    T &back() {
+        if (!tail) throw std::runtime_error("List is empty");
+        return *tail;
+    }
+
+    bool contains(const T &value) const {
+        for (T *curr = head; curr; curr = curr->next) {
+            if (*curr == value) return true;
+        }
+        return false;
+    }
+
+    bool remove(const T &value) {
+        T *prev = nullptr;
+        for (T *curr = head; curr; prev = curr, curr = curr->next) {
+            if (*curr == value) {
+                unlink_after(prev, curr);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Unlinks an object that is in this list by walking to its predecessor.
+    void erase(T &obj) {
+        T *prev = nullptr;
+        for (T *curr = head; curr != &obj; prev = curr, curr = curr->next) {
+        }
+        unlink_after(prev, &obj);
+    }
+
+    void clear() {
+        while (head) {
+            T *tmp = head;
+            head = head->next;
+            tmp->next = nullptr;
+        }
+        tail = nullptr;
+        count = 0;
+    }
+
+    template<typename Compare = std::less<> >
+    void sort(Compare comp = {}) {
+        head = merge_sort(head, comp, &tail);
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    class Iterator {
+        T *curr;
+
+        friend class IntrusiveSinglyLinkedList;
+
+    public:
+        explicit Iterator(T *n) : curr(n) {
+        }
+
+        T &operator*() { return *curr; }
+
+        Iterator &operator++() {
+            curr = curr->next;
+            return *this;
+        }
+
+        bool operator!=(const Iterator &o) const { return curr != o.curr; }
+    };
+
+    // Links obj in after pos, which must be dereferenceable. O(1).
+    Iterator insert_after(Iterator pos, T &obj) {
+        obj.next = pos.curr->next;
+        pos.curr->next = &obj;
+        if (pos.curr == tail) tail = &obj;
+        ++count;
+        return Iterator(&obj);
+    }
+
+    // Unlinks the object after pos. O(1).
+    void erase_after(Iterator pos) {
+        if (pos.curr->next) unlink_after(pos.curr, pos.curr->next);
+    }
+
+    Iterator begin() { return Iterator(head); }
+    Iterator end() { return Iterator(nullptr); }
+};
+
+#endif //INTRUSIVE_SINGLY_LINKED_LIST_H
@@ -0,0 +1,402 @@
+﻿#ifndef LINKED_HASH_MAP_H
+#define LINKED_HASH_MAP_H
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+// Doubly linked list of key/value entries with an open-addressing hash
+// index over the nodes. The list keeps the entries in use order (front is
+// the most recent); the index is a linear-probing table of node pointers
+// with backward-shift deletion, so lookup, erase, move_to_front and
+// pop_back are O(1) expected with no tombstones left behind.
+template<typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>,
+    typename Alloc = std::allocator<std::pair<const K, V> > >
+class LinkedHashMap {
+public:
+    using value_type = std::pair<const K, V>;
+
+private:
+    struct Node {
+        value_type entry;
+        Node *prev = nullptr;
+        Node *next = nullptr;
+        size_t hash;
+
+        template<typename Key, typename... Args>
+        explicit Node(size_t h, Key &&key, Args &&... args)
+            : entry(std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)),
+                    std::forward_as_tuple(std::forward<Args>(args)...)), hash(h) {
+        }
+    };
+
+    using NodeAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAlloc>;
+    using SlotAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Node *>;
+    using SlotTraits = std::allocator_traits<SlotAlloc>;
+
+    Node *head = nullptr;
+    Node *tail = nullptr;
+    size_t count = 0;
+    Node **slots = nullptr;
+    size_t capacity = 0;
+    int shift = 64;
+    [[no_unique_address]] Hash hasher;
+    [[no_unique_address]] KeyEqual equal;
+    [[no_unique_address]] NodeAlloc alloc;
+
+    // Fibonacci hashing spreads weak hashes such as std::hash<int> over the
+    // table; the top bits pick the home slot.
+    size_t hash_of(const K &key) const {
+        return static_cast<size_t>(static_cast<uint64_t>(hasher(key)) * 0x9E3779B97F4A7C15ull);
+    }
+
+    size_t home(size_t hash) const { return hash >> shift; }
+
+    size_t mask() const { return capacity - 1; }
+
+    // Index of the slot holding key, or of the empty slot ending its probe.
+    size_t probe(const K &key, size_t hash) const {
+        size_t i = home(hash);
+        while (slots[i] && !(slots[i]->hash == hash && equal(slots[i]->entry.first, key))) i = (i + 1) & mask();
+        return i;
+    }
+
+    Node *find_node(const K &key) const {
+        if (!count) return nullptr;
+        return slots[probe(key, hash_of(key))];
+    }
+
+    void rehash(size_t new_capacity) {
+        SlotAlloc slot_alloc(alloc);
+        Node **fresh = SlotTraits::allocate(slot_alloc, new_capacity);
+        std::fill(fresh, fresh + new_capacity, nullptr);
+        if (slots) SlotTraits::deallocate(slot_alloc, slots, capacity);
+
+        slots = fresh;
+        capacity = new_capacity;
+        shift = 64 - std::countr_zero(new_capacity);
+        for (Node *n = head; n; n = n->next) {
+            size_t i = home(n->hash);
+            while (slots[i]) i = (i + 1) & mask();
+            slots[i] = n;
+        }
+    }
+
+    // Keeps the load factor at or below 3/4.
+    void grow_for(size_t n) {
+        size_t needed = capacity ? capacity : 8;
+        while (n * 4 > needed * 3) needed *= 2;
+        if (needed != capacity) rehash(needed);
+    }
+
+    void unindex(Node *node) {
+        size_t i = home(node->hash);
+        while (slots[i] != node) i = (i + 1) & mask();
+
+        // Backward-shift: pull later entries of the cluster into the hole
+        // unless that would move them before their home slot.
+        for (size_t j = (i + 1) & mask(); slots[j]; j = (j + 1) & mask()) {
+            size_t k = home(slots[j]->hash);
+            bool movable = i <= j ? (k <= i || k > j) : (k <= i && k > j);
+            if (movable) {
+                slots[i] = slots[j];
+                i = j;
+            }
+        }
+        slots[i] = nullptr;
+    }
+
+    void link_front(Node *node) {
+        node->prev = nullptr;
+        node->next = head;
+        if (head) head->prev = node;
+        else tail = node;
+        head = node;
+    }
+
+    void link_back(Node *node) {
+        node->next = nullptr;
+        node->prev = tail;
+        if (tail) tail->next = node;
+        else head = node;
+        tail = node;
+    }
+
+    void unlink(Node *node) {
+        if (node->prev) node->prev->next = node->next;
+        else head = node->next;
+        if (node->next) node->next->prev = node->prev;
+        else tail = node->prev;
+    }
+
+    template<typename... Args>
+    Node *create_node(Args &&... args) {
+        Node *node = NodeTraits::allocate(alloc, 1);
+        try {
+            NodeTraits::construct(alloc, node, std::forward<Args>(args)...);
+        } catch (...) {
+            NodeTraits::deallocate(alloc, node, 1);
+            throw;
+        }
+        return node;
+    }
+
+    void destroy_node(Node *node) {
+        NodeTraits::destroy(alloc, node);
+        NodeTraits::deallocate(alloc, node, 1);
+    }
+
+    void free_slots() {
+        if (slots) {
+            SlotAlloc slot_alloc(alloc);
+            SlotTraits::deallocate(slot_alloc, slots, capacity);
+        }
+        slots = nullptr;
+        capacity = 0;
+        shift = 64;
+    }
+
+    // Inserts a new entry for key, or returns the existing one untouched.
+    template<bool Front, typename Key, typename... Args>
+    std::pair<Node *, bool> try_emplace(Key &&key, Args &&... args) {
+        grow_for(count + 1);
+        size_t hash = hash_of(key);
+        size_t i = probe(key, hash);
+        if (slots[i]) return {slots[i], false};
+
+        Node *node = create_node(hash, std::forward<Key>(key), std::forward<Args>(args)...);
+        slots[i] = node;
+        if constexpr (Front) link_front(node);
+        else link_back(node);
+        ++count;
+        return {node, true};
+    }
+
+    value_type pop(Node *node) {
+        unindex(node);
+        unlink(node);
+        --count;
+        value_type entry(std::move(node->entry));
+        destroy_node(node);
+        return entry;
+    }
+
+public:
+    class Iterator;
+
+    LinkedHashMap() = default;
+
+    explicit LinkedHashMap(const Alloc &a) : alloc(a) {
+    }
+
+    ~LinkedHashMap() {
+        clear();
+        free_slots();
+    }
+
+    LinkedHashMap(const LinkedHashMap &) = delete;
+
+    LinkedHashMap &operator=(const LinkedHashMap &) = delete;
+
+    LinkedHashMap(LinkedHashMap &&other) noexcept
+        : head(other.head), tail(other.tail), count(other.count), slots(other.slots), capacity(other.capacity),
+          shift(other.shift), hasher(other.hasher), equal(other.equal), alloc(other.alloc) {
+        other.head = other.tail = nullptr;
+        other.count = 0;
+        other.slots = nullptr;
+        other.capacity = 0;
+        other.shift = 64;
+    }
+
+    LinkedHashMap &operator=(LinkedHashMap &&other) noexcept {
+        if (this != &other) {
+            clear();
+            free_slots();
+            head = other.head;
+            tail = other.tail;
+            count = other.count;
+            slots = other.slots;
+            capacity = other.capacity;
+            shift = other.shift;
+            hasher = other.hasher;
+            equal = other.equal;
+            alloc = other.alloc;
+            other.head = other.tail = nullptr;
+            other.count = 0;
+            other.slots = nullptr;
+            other.capacity = 0;
+            other.shift = 64;
+        }
+        return *this;
+    }
+
+    // Adds key at the front. If key is already present nothing is
+    // constructed and the existing entry is returned with false.
+    template<typename... Args>
+    std::pair<Iterator, bool> emplace_front(const K &key, Args &&... args) {
+        auto [node, inserted] = try_emplace<true>(key, std::forward<Args>(args)...);
+        return {Iterator(node), inserted};
+    }
+
+    template<typename... Args>
+    std::pair<Iterator, bool> emplace_back(const K &key, Args &&... args) {
+        auto [node, inserted] = try_emplace<false>(key, std::forward<Args>(args)...);
+        return {Iterator(node), inserted};
+    }
+
+    // Sets the value for key and moves its entry to the front.
+    V &put_front(const K &key, V value) {
+        auto [node, inserted] = try_emplace<true>(key, std::move(value));
+        if (!inserted) {
+            node->entry.second = std::move(value);
+            move_to_front(Iterator(node));
+        }
+        return node->entry.second;
+    }
+
+    Iterator find(const K &key) const { return Iterator(find_node(key)); }
+
+    bool contains(const K &key) const { return find_node(key) != nullptr; }
+
+    V &at(const K &key) {
+        Node *node = find_node(key);
+        if (!node) throw std::out_of_range("Key not found");
+        return node->entry.second;
+    }
+
+    void move_to_front(Iterator pos) {
+        Node *node = pos.curr;
+        if (node == head) return;
+        unlink(node);
+        link_front(node);
+    }
+
+    void move_to_back(Iterator pos) {
+        Node *node = pos.curr;
+        if (node == tail) return;
+        unlink(node);
+        link_back(node);
+    }
+
+    // Moves key to the front; false if it is not present.
+    bool move_to_front(const K &key) {
+        Node *node = find_node(key);
+        if (!node) return false;
+        move_to_front(Iterator(node));
+        return true;
+    }
+
+    Iterator erase(Iterator pos) {
+        Node *node = pos.curr;
+        Node *next = node->next;
+        unindex(node);
+        unlink(node);
+        --count;
+        destroy_node(node);
+        return Iterator(next);
+    }
+
+    bool erase(const K &key) {
+        Node *node = find_node(key);
+        if (!node) return false;
+        erase(Iterator(node));
+        return true;
+    }
+
+    value_type pop_front() {
+        if (!head) throw std::runtime_error("List is empty");
+        return pop(head);
+    }
+
+    // Removes the least recently used entry.
+    value_type pop_back() {
+        if (!tail) throw std::runtime_error("List is empty");
+        return pop(tail);
+    }
+
+    value_type &front() {
+        if (!head) throw std::runtime_error("List is empty");
+        return head->entry;
+    }
+
+    value_type &back() {
+        if (!tail) throw std::runtime_error("List is empty");
+        return tail->entry;
+    }
+
+    // Sizes the index for n entries without further rehashing.
+    void reserve(size_t n) { grow_for(n); }
+
+    void clear() {
+        while (head) {
+            Node *tmp = head;
+            head = head->next;
+            destroy_node(tmp);
+        }
+        tail = nullptr;
+        count = 0;
+        if (slots) std::fill(slots, slots + capacity, nullptr);
+    }
+
+    Alloc get_allocator() const { return Alloc(alloc); }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    class Iterator {
+        Node *curr;
+
+        friend class LinkedHashMap;
+
+    public:
+        Iterator(Node *n) : curr(n) {
+        }
+
+        value_type &operator*() { return curr->entry; }
+        value_type *operator->() { return &curr->entry; }
+
+        Iterator &operator++() {
+            curr = curr->next;
+            return *this;
+        }
+
+        Iterator &operator--() {
+            curr = curr->prev;
+            return *this;
+        }
+
+        bool operator==(const Iterator &o) const { return curr == o.curr; }
+        bool operator!=(const Iterator &o) const { return curr != o.curr; }
+    };
+
+    class ReverseIterator {
+        Node *curr;
+
+    public:
+        ReverseIterator(Node *n) : curr(n) {
+        }
+
+        value_type &operator*() { return curr->entry; }
+        value_type *operator->() { return &curr->entry; }
+
+        ReverseIterator &operator++() {
+            curr = curr->prev;
+            return *this;
+        }
+
+        bool operator!=(const ReverseIterator &o) const { return curr != o.curr; }
+    };
+
+    Iterator begin() { return Iterator(head); }
+    Iterator end() const { return Iterator(nullptr); }
+    ReverseIterator rbegin() { return ReverseIterator(tail); }
+    ReverseIterator rend() { return ReverseIterator(nullptr); }
+};
+
+#endif //LINKED_HASH_MAP_H
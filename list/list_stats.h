@@ -0,0 +1,148 @@
+﻿#ifndef LIST_STATS_H
+#define LIST_STATS_H
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Stats policies for the list templates' Stats parameter. NoStats, the
+// default, is an empty member whose hooks compile to nothing. ListStats
+// counts operations and keeps a histogram of how many nodes each contains()
+// and remove() call walked, which is what shows a list being used as a
+// lookup structure. The counters are plain integers, as unsynchronized as
+// the lists themselves.
+struct NoStats {
+    void on_push() {
+    }
+
+    void on_pop() {
+    }
+
+    void on_allocate(size_t = 1) {
+    }
+
+    void on_free(size_t = 1) {
+    }
+
+    void on_compact() {
+    }
+
+    void on_contains(size_t) {
+    }
+
+    void on_remove(size_t) {
+    }
+};
+
+// Bucket 0 counts walks of no nodes, bucket b > 0 walks of 2^(b-1) to
+// 2^b - 1 nodes; the last bucket also takes everything longer.
+struct TraversalHistogram {
+    static constexpr size_t bucket_count = 33;
+
+    uint64_t buckets[bucket_count] = {};
+    uint64_t calls = 0;
+    uint64_t nodes = 0;
+
+    void record(size_t length) {
+        size_t bucket = std::bit_width(length);
+        ++buckets[bucket < bucket_count ? bucket : bucket_count - 1];
+        ++calls;
+        nodes += length;
+    }
+
+    // Longest walk counted by `bucket`.
+    static uint64_t upper_bound(size_t bucket) { return (uint64_t{1} << bucket) - 1; }
+};
+
+struct ListStats {
+    uint64_t pushes = 0;
+    uint64_t pops = 0;
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t compactions = 0;
+    TraversalHistogram contains;
+    TraversalHistogram remove;
+
+    void on_push() { ++pushes; }
+    void on_pop() { ++pops; }
+    void on_allocate(size_t n = 1) { allocations += n; }
+    void on_free(size_t n = 1) { frees += n; }
+    void on_compact() { ++compactions; }
+    void on_contains(size_t visited) { contains.record(visited); }
+    void on_remove(size_t visited) { remove.record(visited); }
+};
+
+inline void append_histogram_json(std::string &out, const TraversalHistogram &h) {
+    out += "{\"calls\": " + std::to_string(h.calls) + ", \"nodes_visited\": " + std::to_string(h.nodes) +
+            ", \"buckets\": [";
+    bool first = true;
+    for (size_t b = 0; b < TraversalHistogram::bucket_count; ++b) {
+        if (!h.buckets[b]) continue;
+        if (!first) out += ", ";
+        first = false;
+        const std::string le = b + 1 < TraversalHistogram::bucket_count
+                                   ? std::to_string(TraversalHistogram::upper_bound(b))
+                                   : "\"+Inf\"";
+        out += "{\"le\": " + le + ", \"count\": " + std::to_string(h.buckets[b]) + "}";
+    }
+    out += "]}";
+}
+
+// One JSON object; empty histogram buckets are left out, and the last
+// bucket's bound is the string "+Inf".
+inline std::string to_json(const ListStats &s) {
+    std::string out = "{\"pushes\": " + std::to_string(s.pushes) + ", \"pops\": " + std::to_string(s.pops) +
+                      ", \"allocations\": " + std::to_string(s.allocations) + ", \"frees\": " +
+                      std::to_string(s.frees) + ", \"compactions\": " + std::to_string(s.compactions) +
+                      ", \"contains\": ";
+    append_histogram_json(out, s.contains);
+    out += ", \"remove\": ";
+    append_histogram_json(out, s.remove);
+    out += "}";
+    return out;
+}
+
+// Prometheus text exposition for any number of named lists, each metric
+// family written once with a list="name" label per list. Every histogram
+// has the same buckets, the last one being +Inf. Names are used as given
+// and must not contain quotes or backslashes.
+inline std::string to_prometheus(const std::vector<std::pair<std::string, ListStats> > &lists) {
+    std::string out;
+    auto counter = [&](const char *metric, const char *help, uint64_t ListStats::*field) {
+        out += std::string("# HELP linked_list_") + metric + " " + help + "\n";
+        out += std::string("# TYPE linked_list_") + metric + " counter\n";
+        for (const auto &[name, s]: lists) {
+            out += std::string("linked_list_") + metric + "{list=\"" + name + "\"} " + std::to_string(s.*field) +
+                    "\n";
+        }
+    };
+    counter("pushes_total", "Elements pushed or emplaced at either end.", &ListStats::pushes);
+    counter("pops_total", "Elements popped from either end.", &ListStats::pops);
+    counter("allocations_total", "Nodes constructed.", &ListStats::allocations);
+    counter("frees_total", "Nodes destroyed.", &ListStats::frees);
+    counter("compactions_total", "compact() runs.", &ListStats::compactions);
+
+    out += "# HELP linked_list_traversal_nodes Nodes visited per contains() or remove() call.\n";
+    out += "# TYPE linked_list_traversal_nodes histogram\n";
+    for (const auto &[name, s]: lists) {
+        for (auto [op, h]: {std::pair{"contains", &s.contains}, std::pair{"remove", &s.remove}}) {
+            const std::string labels = "list=\"" + name + "\",op=\"" + op + "\"";
+            uint64_t cumulative = 0;
+            for (size_t b = 0; b < TraversalHistogram::bucket_count; ++b) {
+                cumulative += h->buckets[b];
+                const std::string le = b + 1 < TraversalHistogram::bucket_count
+                                           ? std::to_string(TraversalHistogram::upper_bound(b))
+                                           : "+Inf";
+                out += "linked_list_traversal_nodes_bucket{" + labels + ",le=\"" + le + "\"} " +
+                        std::to_string(cumulative) + "\n";
+            }
+            out += "linked_list_traversal_nodes_sum{" + labels + "} " + std::to_string(h->nodes) + "\n";
+            out += "linked_list_traversal_nodes_count{" + labels + "} " + std::to_string(h->calls) + "\n";
+        }
+    }
+    return out;
+}
+
+#endif //LIST_STATS_H
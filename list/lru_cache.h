@@ -0,0 +1,73 @@
+﻿#ifndef LRU_CACHE_H
+#define LRU_CACHE_H
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include "linked_hash_map.h"
+
+// Fixed-capacity least-recently-used cache over LinkedHashMap. get() and
+// put() move the entry to the front; a put() into a full cache evicts the
+// back entry first. Hits and misses of get() are counted.
+template<typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>,
+    typename Alloc = std::allocator<std::pair<const K, V> > >
+class LRUCache {
+    LinkedHashMap<K, V, Hash, KeyEqual, Alloc> entries;
+    size_t limit;
+    uint64_t hit_count = 0;
+    uint64_t miss_count = 0;
+
+public:
+    explicit LRUCache(size_t capacity, const Alloc &a = Alloc()) : entries(a), limit(capacity) {
+        if (capacity == 0) throw std::invalid_argument("LRUCache capacity must be positive");
+        entries.reserve(capacity);
+    }
+
+    // Value for key, or nullptr on a miss. The pointer stays valid until
+    // the entry is evicted or erased.
+    V *get(const K &key) {
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            ++miss_count;
+            return nullptr;
+        }
+        ++hit_count;
+        entries.move_to_front(it);
+        return &it->second;
+    }
+
+    // Looks key up without touching the recency order or the counters.
+    const V *peek(const K &key) const {
+        auto it = entries.find(key);
+        return it == entries.end() ? nullptr : &it->second;
+    }
+
+    V &put(const K &key, V value) {
+        if (entries.size() == limit && !entries.contains(key)) entries.pop_back();
+        return entries.put_front(key, std::move(value));
+    }
+
+    bool erase(const K &key) { return entries.erase(key); }
+
+    bool contains(const K &key) const { return entries.contains(key); }
+
+    void clear() { entries.clear(); }
+
+    void reset_stats() { hit_count = miss_count = 0; }
+
+    uint64_t hits() const { return hit_count; }
+    uint64_t misses() const { return miss_count; }
+
+    double hit_rate() const {
+        uint64_t total = hit_count + miss_count;
+        return total ? static_cast<double>(hit_count) / static_cast<double>(total) : 0.0;
+    }
+
+    size_t capacity() const { return limit; }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+};
+
+#endif //LRU_CACHE_H
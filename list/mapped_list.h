@@ -0,0 +1,260 @@
+﻿#ifndef MAPPED_LIST_H
+#define MAPPED_LIST_H
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "../memory/list_image.h"
+#include "doubly_linked_list.h"
+#include "singly_linked_list.h"
+
+// List image written by save_list() from a SinglyLinkedList or
+// DoublyLinkedList, mapped back with mmap and walked in place: no per-node
+// allocation or deserialisation, pages are faulted in as iteration reaches
+// them. This header is the opt-in for persistence; the list headers
+// themselves stay free of POSIX.
+//
+// In MapMode::copy_on_write the image is mapped privately and followed by
+// `reserve` bytes of anonymous memory, so pushes and pops work as on a
+// regular list (new nodes are bump-allocated after the image, popped nodes
+// are not reused) while the file itself is never modified. save() writes
+// the current contents out again.
+template<typename T, bool Doubly>
+class MappedList {
+    static_assert(std::is_trivially_copyable_v<T>, "mapped lists need trivially copyable values");
+
+public:
+    static constexpr size_t default_reserve = size_t{1} << 30;
+
+private:
+    using Node = ListImageNode<T, Doubly>;
+
+    MappedRegion region;
+    MapMode mode;
+
+    ListImageHeader *header() const { return std::launder(reinterpret_cast<ListImageHeader *>(region.data())); }
+
+    Node *node_at(uint64_t offset) const {
+        return offset ? std::launder(reinterpret_cast<Node *>(region.data() + offset)) : nullptr;
+    }
+
+    void check_writable() const {
+        if (mode != MapMode::copy_on_write) throw std::runtime_error("List is mapped read-only");
+    }
+
+    // A node offset as stored in the image: 0 for none, otherwise the start
+    // of a whole node inside [data offset, end).
+    static bool valid_link(uint64_t offset, uint64_t end) {
+        constexpr uint64_t data = list_image_data_offset<T, Doubly>;
+        return offset == 0 || (offset >= data && offset < end && (offset - data) % sizeof(Node) == 0);
+    }
+
+    // Checks the header and the head and tail offsets. The next/prev offsets
+    // inside the nodes are trusted as written by save_list(): checking them
+    // would mean walking, and faulting in, the whole image up front.
+    void validate(const std::string &path) const {
+        const ListImageHeader *h = header();
+        constexpr uint64_t data = list_image_data_offset<T, Doubly>;
+        bool ok = std::memcmp(h->magic, list_image_magic, sizeof(h->magic)) == 0 &&
+                  h->version == list_image_version &&
+                  h->flags == (Doubly ? list_image_doubly : 0) &&
+                  h->value_size == sizeof(T) && h->value_align == alignof(T) && h->node_size == sizeof(Node) &&
+                  h->end >= data && h->end <= region.file_size() && (h->end - data) % sizeof(Node) == 0 &&
+                  h->count == (h->end - data) / sizeof(Node) &&
+                  valid_link(h->head, h->end) && valid_link(h->tail, h->end) &&
+                  (h->head == 0) == (h->count == 0) && (h->tail == 0) == (h->count == 0);
+        if (!ok) throw std::runtime_error("Not a matching list image: " + path);
+    }
+
+    uint64_t allocate_node() {
+        ListImageHeader *h = header();
+        if (h->end + sizeof(Node) > region.size()) throw std::length_error("Mapped list reserve exhausted");
+        uint64_t offset = h->end;
+        h->end += sizeof(Node);
+        return offset;
+    }
+
+public:
+    explicit MappedList(const std::string &path, MapMode m = MapMode::read_only, size_t reserve = default_reserve)
+        : region(path, m, reserve), mode(m) {
+        validate(path);
+    }
+
+    MappedList(MappedList &&) noexcept = default;
+
+    MappedList &operator=(MappedList &&) noexcept = default;
+
+    void push_back(const T &value) {
+        check_writable();
+        ListImageHeader *h = header();
+        uint64_t offset = allocate_node();
+        Node *node = node_at(offset);
+        std::memcpy(static_cast<void *>(&node->value), &value, sizeof(T));
+        node->next = 0;
+        if constexpr (Doubly) node->prev = h->tail;
+
+        if (h->tail) node_at(h->tail)->next = offset;
+        else h->head = offset;
+        h->tail = offset;
+        ++h->count;
+    }
+
+    void push_front(const T &value) {
+        check_writable();
+        ListImageHeader *h = header();
+        uint64_t offset = allocate_node();
+        Node *node = node_at(offset);
+        std::memcpy(static_cast<void *>(&node->value), &value, sizeof(T));
+        node->next = h->head;
+        if constexpr (Doubly) {
+            node->prev = 0;
+            if (h->head) node_at(h->head)->prev = offset;
+        }
+
+        if (!h->head) h->tail = offset;
+        h->head = offset;
+        ++h->count;
+    }
+
+    T pop_front() {
+        check_writable();
+        ListImageHeader *h = header();
+        if (!h->head) throw std::runtime_error("List is empty");
+
+        Node *node = node_at(h->head);
+        T value = node->value;
+        h->head = node->next;
+        if (h->head) {
+            if constexpr (Doubly) node_at(h->head)->prev = 0;
+        } else {
+            h->tail = 0;
+        }
+        --h->count;
+        return value;
+    }
+
+    T pop_back() requires Doubly {
+        check_writable();
+        ListImageHeader *h = header();
+        if (!h->tail) throw std::runtime_error("List is empty");
+
+        Node *node = node_at(h->tail);
+        T value = node->value;
+        h->tail = node->prev;
+        if (h->tail) node_at(h->tail)->next = 0;
+        else h->head = 0;
+        --h->count;
+        return value;
+    }
+
+    const T &front() const {
+        if (!header()->head) throw std::runtime_error("List is empty");
+        return node_at(header()->head)->value;
+    }
+
+    const T &back() const {
+        if (!header()->tail) throw std::runtime_error("List is empty");
+        return node_at(header()->tail)->value;
+    }
+
+    bool contains(const T &value) const {
+        for (Node *curr = node_at(header()->head); curr; curr = node_at(curr->next)) {
+            if (curr->value == value) return true;
+        }
+        return false;
+    }
+
+    // Writes the current contents as a fresh, compact image.
+    void save(const std::string &path) const {
+        ListImageWriter<T, Doubly> out(path, size());
+        for (Node *curr = node_at(header()->head); curr; curr = node_at(curr->next)) out.write(curr->value);
+        out.finish();
+    }
+
+    MapMode map_mode() const { return mode; }
+
+    size_t size() const { return static_cast<size_t>(header()->count); }
+    bool empty() const { return header()->count == 0; }
+
+    class Iterator {
+        const MappedList *list;
+        Node *curr;
+
+    public:
+        Iterator(const MappedList *l, Node *n) : list(l), curr(n) {
+        }
+
+        const T &operator*() { return curr->value; }
+
+        Iterator &operator++() {
+            curr = list->node_at(curr->next);
+            return *this;
+        }
+
+        bool operator!=(const Iterator &other) const { return curr != other.curr; }
+    };
+
+    class ReverseIterator {
+        const MappedList *list;
+        Node *curr;
+
+    public:
+        ReverseIterator(const MappedList *l, Node *n) : list(l), curr(n) {
+        }
+
+        const T &operator*() { return curr->value; }
+
+        ReverseIterator &operator++() {
+            curr = list->node_at(curr->prev);
+            return *this;
+        }
+
+        bool operator!=(const ReverseIterator &other) const { return curr != other.curr; }
+    };
+
+    Iterator begin() const { return Iterator(this, node_at(header()->head)); }
+    Iterator end() const { return Iterator(this, nullptr); }
+
+    ReverseIterator rbegin() const requires Doubly { return ReverseIterator(this, node_at(header()->tail)); }
+    ReverseIterator rend() const requires Doubly { return ReverseIterator(this, nullptr); }
+};
+
+template<typename List>
+struct list_image_layout;
+
+template<typename T, typename Alloc, typename Prefetch, typename Stats, size_t Inline>
+struct list_image_layout<SinglyLinkedList<T, Alloc, Prefetch, Stats, Inline> > {
+    static constexpr bool doubly = false;
+};
+
+template<typename T, typename Alloc, typename Prefetch, typename Stats, size_t Inline>
+struct list_image_layout<DoublyLinkedList<T, Alloc, Prefetch, Stats, Inline> > {
+    static constexpr bool doubly = true;
+};
+
+template<typename List>
+using mapped_list_for = MappedList<typename List::value_type, list_image_layout<List>::doubly>;
+
+// Writes the list as an offset-based image that map_list() can reopen
+// without rebuilding it.
+template<typename List>
+void save_list(const List &list, const std::string &path)
+    requires std::is_trivially_copyable_v<typename List::value_type> {
+    ListImageWriter<typename List::value_type, list_image_layout<List>::doubly> out(path, list.size());
+    for (const auto &value: list) out.write(value);
+    out.finish();
+}
+
+// e.g. map_list<DoublyLinkedList<int> >(path) for an image saved from a
+// DoublyLinkedList<int>.
+template<typename List>
+mapped_list_for<List> map_list(const std::string &path, MapMode mode = MapMode::read_only,
+                               size_t reserve = mapped_list_for<List>::default_reserve) {
+    return mapped_list_for<List>(path, mode, reserve);
+}
+
+#endif //MAPPED_LIST_H
@@ -0,0 +1,133 @@
+﻿#ifndef SHARDED_LIST_H
+#define SHARDED_LIST_H
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include "doubly_linked_list.h"
+
+// Multiset for many threads: elements are hash-partitioned over Shards
+// DoublyLinkedLists, each on its own cache lines behind its own
+// reader-writer lock. contains() and remove() lock only the element's
+// shard, so calls on different shards, and lookups on the same one, run in
+// parallel. size() takes no lock at all.
+template<typename T, typename Hash = std::hash<T>, size_t Shards = 64, typename Alloc = std::allocator<T> >
+class ShardedList {
+    static_assert(std::has_single_bit(Shards), "shard count must be a power of two");
+
+    static constexpr size_t cache_line = 64;
+    static constexpr int shift = 64 - std::countr_zero(Shards);
+
+    // The shard lists use the default policies: a prefetch or stats policy
+    // would write to the list from contains(), which runs under a shared
+    // lock.
+    struct alignas(cache_line) Shard {
+        mutable std::shared_mutex mutex;
+        DoublyLinkedList<T, Alloc> list;
+        std::atomic<size_t> count{0};
+    };
+
+    std::unique_ptr<Shard[]> shards;
+    [[no_unique_address]] Hash hasher;
+
+    // Fibonacci hashing, as in LinkedHashMap: the top bits pick the shard.
+    Shard &shard_of(const T &value) const {
+        if constexpr (Shards == 1) {
+            return shards[0];
+        } else {
+            uint64_t h = static_cast<uint64_t>(hasher(value)) * 0x9E3779B97F4A7C15ull;
+            return shards[static_cast<size_t>(h >> shift)];
+        }
+    }
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using allocator_type = Alloc;
+
+    explicit ShardedList(const Hash &hash = Hash(), const Alloc &a = Alloc())
+        : shards(new Shard[Shards]), hasher(hash) {
+        for (size_t i = 0; i < Shards; ++i) shards[i].list = DoublyLinkedList<T, Alloc>(a);
+    }
+
+    ShardedList(const ShardedList &) = delete;
+
+    ShardedList &operator=(const ShardedList &) = delete;
+
+    void push_back(const T &value) { emplace_back(value); }
+
+    void push_back(T &&value) { emplace_back(std::move(value)); }
+
+    // The element is built before any lock is taken, since its hash picks
+    // the shard.
+    template<typename... Args>
+    void emplace_back(Args &&... args) {
+        T value(std::forward<Args>(args)...);
+        Shard &shard = shard_of(value);
+        std::unique_lock lock(shard.mutex);
+        shard.list.push_back(std::move(value));
+        shard.count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Adds value unless an equal element is present; returns whether it did.
+    bool insert(const T &value) {
+        Shard &shard = shard_of(value);
+        std::unique_lock lock(shard.mutex);
+        if (shard.list.contains(value)) return false;
+        shard.list.push_back(value);
+        shard.count.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool contains(const T &value) const {
+        Shard &shard = shard_of(value);
+        std::shared_lock lock(shard.mutex);
+        return shard.list.contains(value);
+    }
+
+    // Removes one element equal to value.
+    bool remove(const T &value) {
+        Shard &shard = shard_of(value);
+        std::unique_lock lock(shard.mutex);
+        if (!shard.list.remove(value)) return false;
+        shard.count.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Sum of per-shard counters. Exact when no writer runs concurrently;
+    // otherwise each shard is read at a slightly different moment.
+    size_t size() const {
+        size_t total = 0;
+        for (size_t i = 0; i < Shards; ++i) total += shards[i].count.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    void clear() {
+        for (size_t i = 0; i < Shards; ++i) {
+            std::unique_lock lock(shards[i].mutex);
+            shards[i].list.clear();
+            shards[i].count.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Calls f on every element, one shard at a time under its shared lock.
+    // f must not call back into this list.
+    template<typename F>
+    void for_each(F f) const {
+        for (size_t i = 0; i < Shards; ++i) {
+            std::shared_lock lock(shards[i].mutex);
+            for (const T &value: shards[i].list) f(value);
+        }
+    }
+
+    static constexpr size_t shard_count() { return Shards; }
+};
+
+#endif //SHARDED_LIST_H
@@ -1,24 +1,248 @@
 ﻿#ifndef SINGLY_LINKED_LIST_H
 #define SINGLY_LINKED_LIST_H
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "../algorithm/prefetch.h"
+#include "../algorithm/traits.h"
+#include "../memory/inline_slots.h"
+#include "../memory/node_blocks.h"
+#include "list_stats.h"
 
-
-template<typename T>
+// With Inline > 0 the first Inline nodes live inside the list object and
+// only longer lists allocate. Inline nodes are moved, not relinked, when
+// the list is moved, spliced or split, so T must be nothrow movable.
+template<typename T, typename Alloc = std::allocator<T>, typename Prefetch = NoPrefetch, typename Stats = NoStats,
+    size_t Inline = 0>
 class SinglyLinkedList {
+    static_assert(Inline == 0 || std::is_nothrow_move_constructible_v<T>,
+                  "inline nodes need a nothrow move constructor");
+
     struct Node {
         T data;
         Node *next;
+        [[no_unique_address]] JumpLink<Node, prefetch_enabled_v<Prefetch> > link;
 
-        explicit Node(const T &val) : data(val), next(nullptr) {
+        template<typename... Args>
+        explicit Node(Args &&... args) : data(std::forward<Args>(args)...), next(nullptr) {
         }
     };
 
+    using NodeAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAlloc>;
+
     Node *head = nullptr;
     Node *tail = nullptr;
     size_t count = 0;
+    [[no_unique_address]] NodeAlloc alloc;
+    NodeBlocks<Node, NodeAlloc> blocks;
+    [[no_unique_address]] mutable Stats recorder;
+    [[no_unique_address]] InlineSlots<Node, Inline> slots;
+
+    template<typename... Args>
+    Node *create_node(Args &&... args) {
+        Node *node = slots.allocate();
+        if (!node) node = NodeTraits::allocate(alloc, 1);
+        try {
+            NodeTraits::construct(alloc, node, std::forward<Args>(args)...);
+        } catch (...) {
+            if (slots.owns(node)) slots.release(node);
+            else NodeTraits::deallocate(alloc, node, 1);
+            throw;
+        }
+        recorder.on_allocate();
+        return node;
+    }
+
+    void destroy_node(Node *node) {
+        NodeTraits::destroy(alloc, node);
+        recorder.on_free();
+        if (slots.owns(node)) slots.release(node);
+        else if (!blocks.release(alloc, node)) NodeTraits::deallocate(alloc, node, 1);
+    }
+
+    // Frees a chain of unlinked nodes threaded through next. The bulk
+    // removals collect their victims first, so the scan itself never calls
+    // into the allocator.
+    void free_chain(Node *node) {
+        while (node) {
+            Node *next = node->next;
+            destroy_node(node);
+            node = next;
+        }
+    }
+
+    // Heap nodes for those of `moving` incoming inline nodes that will not
+    // fit in our free slots. Returns how many were allocated.
+    size_t reserve_spares(size_t moving, Node **spare) {
+        size_t need = moving > slots.available() ? moving - slots.available() : 0;
+        size_t got = 0;
+        try {
+            for (; got < need; ++got) spare[got] = NodeTraits::allocate(alloc, 1);
+        } catch (...) {
+            while (got) NodeTraits::deallocate(alloc, spare[--got], 1);
+            throw;
+        }
+        return need;
+    }
+
+    // Moves every node of the chain first..last that sits in `from` into
+    // one of our slots, or into a spare once those run out, and patches the
+    // links around it. Cannot fail.
+    void relocate_inline(Node *&first, Node *&last, InlineSlots<Node, Inline> &from, Node **spare) noexcept {
+        size_t left = from.live();
+        Node *prev = nullptr;
+        for (Node *curr = first; curr && left; prev = curr, curr = curr->next) {
+            if (!from.owns(curr)) continue;
+            Node *node = slots.allocate();
+            if (!node) node = *spare++;
+            NodeTraits::construct(alloc, node, std::move(curr->data));
+            node->next = curr->next;
+            if (prev) prev->next = node;
+            else first = node;
+            if (curr == last) last = node;
+            NodeTraits::destroy(alloc, curr);
+            from.release(curr);
+            curr = node;
+            --left;
+        }
+    }
+
+    // Automatic compaction is only an optimization: if it fails, the list
+    // is left as it was and the operation that triggered it still succeeds.
+    void maybe_compact() {
+        if (!blocks.due(count) || fragmentation() <= blocks.threshold()) return;
+        try {
+            compact();
+        } catch (...) {
+        }
+    }
+
+    // Moves all of other's nodes in after prev, or at the front when prev is
+    // null. Nodes change owner, so both lists must share an allocator.
+    void link_after(Node *prev, SinglyLinkedList &other) {
+        if (this == &other || !other.head) return;
+        if (!(alloc == other.alloc)) throw std::invalid_argument("Lists use different allocators");
+        if constexpr (Inline > 0) {
+            // Everything that can fail happens before other's inline nodes
+            // are moved over.
+            Node *spare[Inline];
+            size_t spares = reserve_spares(other.slots.live(), spare);
+            try {
+                blocks.take(other.blocks);
+            } catch (...) {
+                while (spares) NodeTraits::deallocate(alloc, spare[--spares], 1);
+                throw;
+            }
+            relocate_inline(other.head, other.tail, other.slots, spare);
+        } else {
+            blocks.take(other.blocks);
+        }
+
+        Node *next = prev ? prev->next : head;
+        other.tail->next = next;
+        if (prev) prev->next = other.head;
+        else head = other.head;
+        if (!next) tail = other.tail;
+        count += other.count;
+
+        other.head = other.tail = nullptr;
+        other.count = 0;
+    }
+
+    // Detaches everything after prev (everything when prev is null) into a
+    // new list; `kept` is how many nodes stay behind.
+    SinglyLinkedList cut_after(Node *prev, size_t kept) {
+        SinglyLinkedList rest(get_allocator());
+        Node *first = prev ? prev->next : head;
+        if (!first) return rest;
+
+        rest.blocks.share(blocks);
+        rest.head = first;
+        rest.tail = tail;
+        rest.count = count - kept;
+        if (prev) prev->next = nullptr;
+        else head = nullptr;
+        tail = prev;
+        count = kept;
+        if constexpr (Inline > 0) rest.relocate_inline(rest.head, rest.tail, slots, nullptr);
+        return rest;
+    }
+
+    // Hands the whole chain back in one go when the allocator can drop its
+    // storage wholesale and this list owns everything in it.
+    bool release_nodes() {
+        if constexpr (has_release_v<NodeAlloc> && std::is_trivially_destructible_v<T>) {
+            if (alloc.live() == count && blocks.empty() && slots.empty()) {
+                recorder.on_free(count);
+                alloc.release();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Copies [first, last) into a detached list in a single linking pass;
+    // tail and count are written once at the end. The nodes come from this
+    // list, inline slots included, so they must be linked back into it.
+    template<typename It, typename S>
+    SinglyLinkedList chain_of(It first, S last) {
+        SinglyLinkedList chain(get_allocator());
+        Node *prev = nullptr;
+        size_t n = 0;
+        try {
+            for (; first != last; ++first, ++n) {
+                Node *node = create_node(*first);
+                if (prev) prev->next = node;
+                else chain.head = node;
+                prev = node;
+            }
+        } catch (...) {
+            while (Node *node = chain.head) {
+                chain.head = node->next;
+                destroy_node(node);
+            }
+            throw;
+        }
+        chain.tail = prev;
+        chain.count = n;
+        return chain;
+    }
+
+    void append_chain(SinglyLinkedList &&chain) { link_after(tail, chain); }
 
 public:
+    using value_type = T;
+    using reference = T &;
+    using const_reference = const T &;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using allocator_type = Alloc;
+
     SinglyLinkedList() = default;
 
+    explicit SinglyLinkedList(const Alloc &a) : alloc(a) {
+    }
+
+    template<std::input_iterator It, std::sentinel_for<It> S>
+    SinglyLinkedList(It first, S last, const Alloc &a = Alloc()) : alloc(a) {
+        append_chain(chain_of(std::move(first), std::move(last)));
+    }
+
+    // Builds a list from any input range, reading it exactly once, so
+    // generators and istream views need no intermediate buffer.
+    template<std::ranges::input_range R>
+    static SinglyLinkedList from_stream(R &&input, const Alloc &a = Alloc()) {
+        SinglyLinkedList list(a);
+        list.append_range(std::forward<R>(input));
+        return list;
+    }
+
     ~SinglyLinkedList() { clear(); }
 
     SinglyLinkedList(const SinglyLinkedList &) = delete;
@@ -26,7 +250,9 @@ public:
     SinglyLinkedList &operator=(const SinglyLinkedList &) = delete;
 
     SinglyLinkedList(SinglyLinkedList &&other) noexcept
-        : head(other.head), tail(other.tail), count(other.count) {
+        : head(other.head), tail(other.tail), count(other.count), alloc(other.alloc),
+          blocks(std::move(other.blocks)) {
+        if constexpr (Inline > 0) relocate_inline(head, tail, other.slots, nullptr);
         other.head = other.tail = nullptr;
         other.count = 0;
     }
@@ -37,22 +263,38 @@ public:
             head = other.head;
             tail = other.tail;
             count = other.count;
+            alloc = other.alloc;
+            blocks = std::move(other.blocks);
+            if constexpr (Inline > 0) relocate_inline(head, tail, other.slots, nullptr);
             other.head = other.tail = nullptr;
             other.count = 0;
         }
         return *this;
     }
 
-    void push_front(const T &value) {
-        Node *node = new Node(value);
+    void push_front(const T &value) { emplace_front(value); }
+
+    void push_front(T &&value) { emplace_front(std::move(value)); }
+
+    template<typename... Args>
+    T &emplace_front(Args &&... args) {
+        Node *node = create_node(std::forward<Args>(args)...);
         node->next = head;
         head = node;
         if (!tail) tail = node;
         ++count;
+        recorder.on_push();
+        maybe_compact();
+        return head->data;
     }
 
-    void push_back(const T &value) {
-        Node *node = new Node(value);
+    void push_back(const T &value) { emplace_back(value); }
+
+    void push_back(T &&value) { emplace_back(std::move(value)); }
+
+    template<typename... Args>
+    T &emplace_back(Args &&... args) {
+        Node *node = create_node(std::forward<Args>(args)...);
         if (tail) {
             tail->next = node;
         } else {
@@ -60,16 +302,21 @@ public:
         }
         tail = node;
         ++count;
+        recorder.on_push();
+        maybe_compact();
+        return tail->data;
     }
 
     T pop_front() {
         if (!head) throw std::runtime_error("List is empty");
         Node *node = head;
-        T value = node->data;
+        T value = std::move(node->data);
         head = head->next;
         if (!head) tail = nullptr;
-        delete node;
+        destroy_node(node);
         --count;
+        recorder.on_pop();
+        maybe_compact();
         return value;
     }
 
@@ -84,60 +331,291 @@ public:
     }
 
     bool contains(const T &value) const {
+        JumpWindow<Node, Prefetch> window;
+        size_t visited = 0;
         for (Node *curr = head; curr; curr = curr->next) {
-            if (curr->data == value) return true;
+            window.visit(curr);
+            ++visited;
+            if (curr->data == value) {
+                recorder.on_contains(visited);
+                return true;
+            }
         }
+        recorder.on_contains(visited);
         return false;
     }
 
     bool remove(const T &value) {
+        JumpWindow<Node, Prefetch> window;
+        size_t visited = 0;
         Node *prev = nullptr;
         for (Node *curr = head; curr; prev = curr, curr = curr->next) {
+            window.visit(curr);
+            ++visited;
             if (curr->data == value) {
+                recorder.on_remove(visited);
                 if (prev) prev->next = curr->next;
                 else head = curr->next;
                 if (curr == tail) tail = prev;
-                delete curr;
+                destroy_node(curr);
                 --count;
+                maybe_compact();
                 return true;
             }
         }
+        recorder.on_remove(visited);
         return false;
     }
 
+    // Removes every element satisfying pred in one pass and returns how
+    // many there were. The nodes are freed together once the scan is done.
+    // If pred throws, what was removed before stays removed.
+    template<typename Pred>
+    size_t remove_if(Pred pred) {
+        JumpWindow<Node, Prefetch> window;
+        Node *dead = nullptr;
+        size_t removed = 0;
+        try {
+            Node *prev = nullptr;
+            for (Node *curr = head, *next; curr; curr = next) {
+                window.visit(curr);
+                next = curr->next;
+                if (!pred(curr->data)) {
+                    prev = curr;
+                    continue;
+                }
+                if (prev) prev->next = next;
+                else head = next;
+                if (!next) tail = prev;
+                curr->next = dead;
+                dead = curr;
+                --count;
+                ++removed;
+            }
+        } catch (...) {
+            free_chain(dead);
+            throw;
+        }
+        free_chain(dead);
+        if (removed) maybe_compact();
+        return removed;
+    }
+
+    size_t remove_all(const T &value) {
+        return remove_if([&value](const T &x) { return x == value; });
+    }
+
+    // Keeps the first of every run of equal neighbours, so a sorted list
+    // ends up with each value once. Returns the number removed.
+    template<typename Eq = std::equal_to<> >
+    size_t unique(Eq eq = {}) {
+        const T *kept = nullptr;
+        return remove_if([&](const T &x) {
+            if (kept && eq(*kept, x)) return true;
+            kept = &x;
+            return false;
+        });
+    }
+
+    // Removes every element contained in values, a std::set, an
+    // unordered_set or anything else with contains().
+    template<typename Set>
+        requires requires(const Set &s, const T &v) { { s.contains(v) } -> std::convertible_to<bool>; }
+    size_t erase(const Set &values) {
+        return remove_if([&values](const T &x) { return values.contains(x); });
+    }
+
     void clear() {
+        if (release_nodes()) {
+            head = nullptr;
+        }
         while (head) {
             Node *tmp = head;
+            JumpWindow<Node, Prefetch>::follow(tmp);
             head = head->next;
-            delete tmp;
+            destroy_node(tmp);
         }
         tail = nullptr;
         count = 0;
+        blocks.reset();
+    }
+
+    // Moves the elements into one new array of nodes, in list order, and
+    // relinks them so that a traversal reads memory sequentially.
+    // Invalidates iterators and references. Values are copied only if
+    // moving T can throw; a failure then leaves the list unchanged.
+    void compact() {
+        if (!head) return;
+        Node *fresh = blocks.allocate(alloc, count);
+        size_t built = 0;
+        try {
+            for (Node *curr = head; curr; curr = curr->next) {
+                NodeTraits::construct(alloc, fresh + built, std::move_if_noexcept(curr->data));
+                // The new node's link holds the old node until it is freed.
+                fresh[built++].next = curr;
+            }
+        } catch (...) {
+            while (built) NodeTraits::destroy(alloc, fresh + --built);
+            blocks.abandon(alloc, fresh);
+            throw;
+        }
+        recorder.on_compact();
+        recorder.on_allocate(count);
+        for (size_t i = 0; i < count; ++i) {
+            destroy_node(fresh[i].next);
+            fresh[i].next = i + 1 < count ? fresh + i + 1 : nullptr;
+        }
+        head = fresh;
+        tail = fresh + count - 1;
     }
 
+    // Share of links, from 0 to 1, that lead more than a few cache lines
+    // away. Walks the whole list.
+    double fragmentation() const {
+        if (count < 2) return 0;
+        size_t far = 0;
+        for (Node *curr = head; curr->next; curr = curr->next) far += nodes_far_apart(curr, curr->next);
+        return static_cast<double>(far) / static_cast<double>(count - 1);
+    }
+
+    // Compacts automatically once fragmentation() exceeds fraction. The
+    // check runs about once per size() pushes, pops and removes, so with
+    // a threshold set those may invalidate iterators. 0 turns it off.
+    void set_compaction_threshold(double fraction) { blocks.set_threshold(fraction); }
+
+    // A copy of the counters; empty unless the list has a Stats policy such
+    // as ListStats.
+    Stats stats() const { return recorder; }
+
+    void reset_stats() { recorder = Stats(); }
+
+    Alloc get_allocator() const { return Alloc(alloc); }
+
     size_t size() const { return count; }
     bool empty() const { return count == 0; }
 
-    class Iterator {
-        Node *curr;
+    // Iterator and ConstIterator share this template; an Iterator converts
+    // to a ConstIterator.
+    template<bool Const>
+    class BasicIterator {
+        Node *curr = nullptr;
+
+        friend class SinglyLinkedList;
+        friend class BasicIterator<!Const>;
 
     public:
-        explicit Iterator(Node *n) : curr(n) {
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T *, T *>;
+        using reference = std::conditional_t<Const, const T &, T &>;
+
+        BasicIterator() = default;
+
+        explicit BasicIterator(Node *n) : curr(n) {
+        }
+
+        template<bool C = Const> requires C
+        BasicIterator(const BasicIterator<false> &o) : curr(o.curr) {
         }
 
-        T &operator*() { return curr->data; }
+        reference operator*() const { return curr->data; }
+        pointer operator->() const { return &curr->data; }
 
-        Iterator &operator++() {
+        BasicIterator &operator++() {
             curr = curr->next;
             return *this;
         }
 
-        bool operator!=(const Iterator &o) const { return curr != o.curr; }
+        BasicIterator operator++(int) {
+            BasicIterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const BasicIterator &o) const { return curr == o.curr; }
     };
 
+    using Iterator = BasicIterator<false>;
+    using ConstIterator = BasicIterator<true>;
+    using iterator = Iterator;
+    using const_iterator = ConstIterator;
+
+    // Inserts other's elements before pos without allocating. O(1) at begin()
+    // or end(); anywhere else the predecessor of pos has to be found first.
+    void splice(Iterator pos, SinglyLinkedList &other) {
+        if (pos.curr == head) {
+            link_after(nullptr, other);
+        } else if (!pos.curr) {
+            link_after(tail, other);
+        } else {
+            Node *prev = head;
+            while (prev->next != pos.curr) prev = prev->next;
+            link_after(prev, other);
+        }
+    }
+
+    // O(1) for any dereferenceable pos.
+    void splice_after(Iterator pos, SinglyLinkedList &other) { link_after(pos.curr, other); }
+
+    void append(SinglyLinkedList &&other) { link_after(tail, other); }
+
+    // Replaces the contents. The new nodes are built before the old ones
+    // are freed, so a throwing element constructor leaves the list intact.
+    template<std::input_iterator It, std::sentinel_for<It> S>
+    void assign(It first, S last) {
+        SinglyLinkedList chain = chain_of(std::move(first), std::move(last));
+        clear();
+        append_chain(std::move(chain));
+    }
+
+    template<std::ranges::input_range R>
+    void assign_range(R &&range) { assign(std::ranges::begin(range), std::ranges::end(range)); }
+
+    // The *_range members link the new nodes in one pass and update the
+    // size once.
+    template<std::ranges::input_range R>
+    void append_range(R &&range) { append_chain(chain_of(std::ranges::begin(range), std::ranges::end(range))); }
+
+    template<std::ranges::input_range R>
+    void prepend_range(R &&range) {
+        SinglyLinkedList chain = chain_of(std::ranges::begin(range), std::ranges::end(range));
+        link_after(nullptr, chain);
+    }
+
+    // Inserts the range before pos.
+    template<std::ranges::input_range R>
+    void insert_range(Iterator pos, R &&range) {
+        SinglyLinkedList chain = chain_of(std::ranges::begin(range), std::ranges::end(range));
+        splice(pos, chain);
+    }
+
+    // Keeps [begin, pos) and returns [pos, end). Walks up to pos.
+    SinglyLinkedList split_at(Iterator pos) {
+        Node *prev = nullptr;
+        size_t kept = 0;
+        for (Node *curr = head; curr != pos.curr; prev = curr, curr = curr->next) ++kept;
+        return cut_after(prev, kept);
+    }
+
+    // Keeps the first n elements and returns the rest.
+    SinglyLinkedList split_after(size_t n) {
+        if (n >= count) return SinglyLinkedList(get_allocator());
+        Node *prev = nullptr;
+        for (size_t i = 0; i < n; ++i) prev = prev ? prev->next : head;
+        return cut_after(prev, n);
+    }
+
     Iterator begin() { return Iterator(head); }
     Iterator end() { return Iterator(nullptr); }
+    ConstIterator begin() const { return ConstIterator(head); }
+    ConstIterator end() const { return ConstIterator(nullptr); }
+    ConstIterator cbegin() const { return begin(); }
+    ConstIterator cend() const { return end(); }
 };
 
+template<typename T, size_t N, typename Alloc = std::allocator<T> >
+using SmallSinglyLinkedList = SinglyLinkedList<T, Alloc, NoPrefetch, NoStats, N>;
+
 
 #endif //SINGLY_LINKED_LIST_H
@@ -0,0 +1,365 @@
+﻿#ifndef SORTED_SKIP_LIST_H
+#define SORTED_SKIP_LIST_H
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+// Sorted doubly linked list with skip-list express lanes (Pugh, 1990) on
+// top. Level 0 is an ordinary prev/next chain, so iteration matches
+// DoublyLinkedList; about a quarter of the nodes also carry a tower of
+// forward links that lets lower_bound, insert and erase run in expected
+// O(log n). Equal elements keep their insertion order.
+template<typename T, typename Compare = std::less<>, typename Alloc = std::allocator<T> >
+class SortedSkipList {
+    static constexpr int max_level = 16;
+
+private:
+    struct Node {
+        T data;
+        Node *prev = nullptr;
+        Node *next = nullptr;
+        Node **up = nullptr;
+        int levels = 0;
+
+        template<typename... Args>
+        explicit Node(Args &&... args) : data(std::forward<Args>(args)...) {
+        }
+    };
+
+    using NodeAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAlloc>;
+    using LinkAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Node *>;
+    using LinkTraits = std::allocator_traits<LinkAlloc>;
+
+    Node *head = nullptr;
+    Node *tail = nullptr;
+    size_t count = 0;
+    // lanes[i] is the first node on express level i + 1.
+    Node *lanes[max_level - 1] = {};
+    int level = 0;
+    uint64_t seed = 0x9E3779B97F4A7C15ull;
+    [[no_unique_address]] Compare comp;
+    [[no_unique_address]] NodeAlloc alloc;
+
+    // Height of a new tower: each extra level with probability 1/4.
+    int random_levels() {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        uint64_t bits = seed;
+        int h = 0;
+        while (h < max_level - 1 && (bits & 3) == 0) {
+            ++h;
+            bits >>= 2;
+        }
+        return h;
+    }
+
+    // Successor of x on level lvl; a null x stands for the header.
+    Node *next_at(Node *x, int lvl) const {
+        if (lvl == 0) return x ? x->next : head;
+        return x ? x->up[lvl - 1] : lanes[lvl - 1];
+    }
+
+    void set_next(Node *x, int lvl, Node *n) {
+        if (lvl == 0) {
+            if (x) x->next = n;
+            else head = n;
+        } else if (x) {
+            x->up[lvl - 1] = n;
+        } else {
+            lanes[lvl - 1] = n;
+        }
+    }
+
+    // Fills preds with the last node on each level ordered before value
+    // (strictly before, or also equal when `after_equal` is set).
+    void find_preds(const T &value, bool after_equal, Node **preds) const {
+        Node *x = nullptr;
+        for (int lvl = level; lvl >= 0; --lvl) {
+            for (Node *n = next_at(x, lvl); n; n = next_at(x, lvl)) {
+                bool before = after_equal ? !comp(value, n->data) : comp(n->data, value);
+                if (!before) break;
+                x = n;
+            }
+            preds[lvl] = x;
+        }
+    }
+
+    template<typename... Args>
+    Node *create_node(int h, Args &&... args) {
+        Node *node = NodeTraits::allocate(alloc, 1);
+        try {
+            NodeTraits::construct(alloc, node, std::forward<Args>(args)...);
+        } catch (...) {
+            NodeTraits::deallocate(alloc, node, 1);
+            throw;
+        }
+        if (h > 0) {
+            try {
+                LinkAlloc links(alloc);
+                node->up = LinkTraits::allocate(links, static_cast<size_t>(h));
+                node->levels = h;
+            } catch (...) {
+                NodeTraits::destroy(alloc, node);
+                NodeTraits::deallocate(alloc, node, 1);
+                throw;
+            }
+        }
+        return node;
+    }
+
+    void destroy_node(Node *node) {
+        if (node->up) {
+            LinkAlloc links(alloc);
+            LinkTraits::deallocate(links, node->up, static_cast<size_t>(node->levels));
+        }
+        NodeTraits::destroy(alloc, node);
+        NodeTraits::deallocate(alloc, node, 1);
+    }
+
+    void link(Node *node, Node **preds) {
+        for (int lvl = level + 1; lvl <= node->levels; ++lvl) preds[lvl] = nullptr;
+        if (node->levels > level) level = node->levels;
+
+        Node *prev = preds[0];
+        Node *next = next_at(prev, 0);
+        node->prev = prev;
+        node->next = next;
+        set_next(prev, 0, node);
+        if (next) next->prev = node;
+        else tail = node;
+
+        for (int lvl = 1; lvl <= node->levels; ++lvl) {
+            node->up[lvl - 1] = next_at(preds[lvl], lvl);
+            set_next(preds[lvl], lvl, node);
+        }
+        ++count;
+    }
+
+    void unlink(Node *node) {
+        if (node->levels > 0) {
+            Node *preds[max_level];
+            find_preds(node->data, false, preds);
+            for (int lvl = 1; lvl <= node->levels; ++lvl) {
+                Node *x = preds[lvl];
+                while (next_at(x, lvl) != node) x = next_at(x, lvl);
+                set_next(x, lvl, node->up[lvl - 1]);
+            }
+            while (level > 0 && !lanes[level - 1]) --level;
+        }
+
+        if (node->prev) node->prev->next = node->next;
+        else head = node->next;
+        if (node->next) node->next->prev = node->prev;
+        else tail = node->prev;
+        --count;
+    }
+
+    // Unlinks before moving the value out: unlink() searches for the node by
+    // its value, which a moved-from key no longer orders correctly.
+    T take_node(Node *node) {
+        unlink(node);
+        // Destroys the node after the return value is built, even if that throws.
+        struct Release {
+            SortedSkipList *list;
+            Node *node;
+
+            ~Release() { list->destroy_node(node); }
+        } release{this, node};
+        return std::move(node->data);
+    }
+
+    Node *lower_node(const T &value) const {
+        Node *preds[max_level];
+        find_preds(value, false, preds);
+        return next_at(preds[0], 0);
+    }
+
+    Node *upper_node(const T &value) const {
+        Node *preds[max_level];
+        find_preds(value, true, preds);
+        return next_at(preds[0], 0);
+    }
+
+public:
+    SortedSkipList() = default;
+
+    explicit SortedSkipList(const Compare &c, const Alloc &a = Alloc()) : comp(c), alloc(a) {
+    }
+
+    ~SortedSkipList() { clear(); }
+
+    SortedSkipList(const SortedSkipList &) = delete;
+
+    SortedSkipList &operator=(const SortedSkipList &) = delete;
+
+    SortedSkipList(SortedSkipList &&other) noexcept
+        : head(other.head), tail(other.tail), count(other.count), level(other.level), seed(other.seed),
+          comp(other.comp), alloc(other.alloc) {
+        std::copy(std::begin(other.lanes), std::end(other.lanes), lanes);
+        other.reset();
+    }
+
+    SortedSkipList &operator=(SortedSkipList &&other) noexcept {
+        if (this != &other) {
+            clear();
+            head = other.head;
+            tail = other.tail;
+            count = other.count;
+            level = other.level;
+            seed = other.seed;
+            std::copy(std::begin(other.lanes), std::end(other.lanes), lanes);
+            comp = other.comp;
+            alloc = other.alloc;
+            other.reset();
+        }
+        return *this;
+    }
+
+    template<typename... Args>
+    T &emplace(Args &&... args) {
+        Node *node = create_node(random_levels(), std::forward<Args>(args)...);
+        Node *preds[max_level];
+        try {
+            find_preds(node->data, true, preds);
+        } catch (...) {
+            destroy_node(node);
+            throw;
+        }
+        link(node, preds);
+        return node->data;
+    }
+
+    // Inserts after any elements equal to value. Expected O(log n).
+    void insert_sorted(const T &value) { emplace(value); }
+
+    void insert_sorted(T &&value) { emplace(std::move(value)); }
+
+    T pop_front() {
+        if (!head) throw std::runtime_error("List is empty");
+        return take_node(head);
+    }
+
+    T pop_back() {
+        if (!tail) throw std::runtime_error("List is empty");
+        return take_node(tail);
+    }
+
+    T &front() {
+        if (!head) throw std::runtime_error("List is empty");
+        return head->data;
+    }
+
+    T &back() {
+        if (!tail) throw std::runtime_error("List is empty");
+        return tail->data;
+    }
+
+    bool contains(const T &value) const {
+        Node *node = lower_node(value);
+        return node && !comp(value, node->data);
+    }
+
+    // Removes the first element equal to value. Expected O(log n).
+    bool remove(const T &value) {
+        Node *node = lower_node(value);
+        if (!node || comp(value, node->data)) return false;
+        unlink(node);
+        destroy_node(node);
+        return true;
+    }
+
+    void clear() {
+        while (head) {
+            Node *tmp = head;
+            head = head->next;
+            destroy_node(tmp);
+        }
+        reset();
+    }
+
+    Alloc get_allocator() const { return Alloc(alloc); }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    class Iterator {
+        Node *curr;
+
+        friend class SortedSkipList;
+
+    public:
+        Iterator(Node *n) : curr(n) {
+        }
+
+        const T &operator*() { return curr->data; }
+
+        Iterator &operator++() {
+            curr = curr->next;
+            return *this;
+        }
+
+        Iterator &operator--() {
+            curr = curr->prev;
+            return *this;
+        }
+
+        bool operator!=(const Iterator &o) const { return curr != o.curr; }
+    };
+
+    class ReverseIterator {
+        Node *curr;
+
+    public:
+        ReverseIterator(Node *n) : curr(n) {
+        }
+
+        const T &operator*() { return curr->data; }
+
+        ReverseIterator &operator++() {
+            curr = curr->prev;
+            return *this;
+        }
+
+        bool operator!=(const ReverseIterator &o) const { return curr != o.curr; }
+    };
+
+    // First element not ordered before value.
+    Iterator lower_bound(const T &value) const { return Iterator(lower_node(value)); }
+
+    // First element ordered after value.
+    Iterator upper_bound(const T &value) const { return Iterator(upper_node(value)); }
+
+    // Elements in [lo, hi).
+    std::pair<Iterator, Iterator> range(const T &lo, const T &hi) const {
+        return {lower_bound(lo), lower_bound(hi)};
+    }
+
+    Iterator erase(Iterator pos) {
+        Node *next = pos.curr->next;
+        unlink(pos.curr);
+        destroy_node(pos.curr);
+        return Iterator(next);
+    }
+
+    Iterator begin() { return Iterator(head); }
+    Iterator end() { return Iterator(nullptr); }
+    ReverseIterator rbegin() { return ReverseIterator(tail); }
+    ReverseIterator rend() { return ReverseIterator(nullptr); }
+
+private:
+    void reset() {
+        head = tail = nullptr;
+        count = 0;
+        level = 0;
+        std::fill(std::begin(lanes), std::end(lanes), nullptr);
+    }
+};
+
+#endif //SORTED_SKIP_LIST_H
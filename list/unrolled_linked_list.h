@@ -0,0 +1,384 @@
+﻿#ifndef UNROLLED_LINKED_LIST_H
+#define UNROLLED_LINKED_LIST_H
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include "../algorithm/search.h"
+
+// Elements per node so that a node fills about two cache lines.
+template<typename T>
+inline constexpr size_t unrolled_capacity =
+        std::max<size_t>(4, (128 - 2 * sizeof(void *) - sizeof(size_t)) / sizeof(T));
+
+template<typename T, size_t N = unrolled_capacity<T>, typename Alloc = std::allocator<T> >
+class UnrolledLinkedList {
+    static_assert(N >= 2, "nodes must hold at least two elements");
+
+private:
+    struct Node {
+        Node *prev = nullptr;
+        Node *next = nullptr;
+        size_t size = 0;
+        alignas(T) unsigned char storage[N * sizeof(T)];
+
+        // User-provided so value-initialization leaves storage untouched.
+        Node() {
+        }
+
+        T *items() { return std::launder(reinterpret_cast<T *>(storage)); }
+        const T *items() const { return std::launder(reinterpret_cast<const T *>(storage)); }
+    };
+
+    using NodeAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAlloc>;
+
+    Node *head = nullptr;
+    Node *tail = nullptr;
+    size_t count = 0;
+    [[no_unique_address]] NodeAlloc alloc;
+
+    Node *create_node() {
+        Node *node = NodeTraits::allocate(alloc, 1);
+        NodeTraits::construct(alloc, node);
+        return node;
+    }
+
+    void destroy_node(Node *node) {
+        std::destroy_n(node->items(), node->size);
+        NodeTraits::destroy(alloc, node);
+        NodeTraits::deallocate(alloc, node, 1);
+    }
+
+    // Links `node` after `pos`, or in front of head when pos is null.
+    void link_after(Node *pos, Node *node) {
+        node->prev = pos;
+        node->next = pos ? pos->next : head;
+        if (node->next) node->next->prev = node;
+        else tail = node;
+        if (pos) pos->next = node;
+        else head = node;
+    }
+
+    void unlink(Node *node) {
+        if (node->prev) node->prev->next = node->next;
+        else head = node->next;
+        if (node->next) node->next->prev = node->prev;
+        else tail = node->prev;
+    }
+
+    // Constructs the first element of a fresh node and only then links the
+    // node after `pos`, so a throwing constructor leaves no empty node behind.
+    template<typename... Args>
+    Node *emplace_node_after(Node *pos, Args &&... args) {
+        Node *node = create_node();
+        try {
+            std::construct_at(node->items(), std::forward<Args>(args)...);
+        } catch (...) {
+            destroy_node(node);
+            throw;
+        }
+        node->size = 1;
+        ++count;
+        link_after(pos, node);
+        return node;
+    }
+
+    // Moves the upper half of a full node into a fresh node after it.
+    void split(Node *node) {
+        Node *right = create_node();
+        size_t half = node->size / 2;
+        size_t moved = node->size - half;
+        try {
+            std::uninitialized_move_n(node->items() + half, moved, right->items());
+        } catch (...) {
+            destroy_node(right);
+            throw;
+        }
+        std::destroy_n(node->items() + half, moved);
+        right->size = moved;
+        node->size = half;
+        link_after(node, right);
+    }
+
+    // Appends the next node's elements when both fit in one node.
+    void merge_next(Node *node) {
+        Node *next = node->next;
+        std::uninitialized_move_n(next->items(), next->size, node->items() + node->size);
+        node->size += next->size;
+        unlink(next);
+        std::destroy_n(next->items(), next->size);
+        next->size = 0;
+        destroy_node(next);
+    }
+
+    // Constructs an element in a node that still has room.
+    template<typename... Args>
+    T *emplace_at(Node *node, size_t idx, Args &&... args) {
+        T *items = node->items();
+        if (idx == node->size) {
+            std::construct_at(items + idx, std::forward<Args>(args)...);
+        } else {
+            T tmp(std::forward<Args>(args)...);
+            std::construct_at(items + node->size, std::move(items[node->size - 1]));
+            std::move_backward(items + idx, items + node->size - 1, items + node->size);
+            items[idx] = std::move(tmp);
+        }
+        ++node->size;
+        ++count;
+        return items + idx;
+    }
+
+    // Removes one element, then frees or merges the node if it ran low.
+    // Returns the position of the element that followed the erased one.
+    std::pair<Node *, size_t> erase_at(Node *node, size_t idx) {
+        T *items = node->items();
+        std::move(items + idx + 1, items + node->size, items + idx);
+        std::destroy_at(items + node->size - 1);
+        --node->size;
+        --count;
+
+        if (node->size == 0) {
+            Node *next = node->next;
+            unlink(node);
+            destroy_node(node);
+            return {next, 0};
+        }
+        if (node->size < N / 2 && node->next && node->size + node->next->size <= N) {
+            merge_next(node);
+        }
+        if (idx == node->size) return {node->next, 0};
+        return {node, idx};
+    }
+
+public:
+    UnrolledLinkedList() = default;
+
+    explicit UnrolledLinkedList(const Alloc &a) : alloc(a) {
+    }
+
+    ~UnrolledLinkedList() { clear(); }
+
+    UnrolledLinkedList(const UnrolledLinkedList &) = delete;
+
+    UnrolledLinkedList &operator=(const UnrolledLinkedList &) = delete;
+
+    UnrolledLinkedList(UnrolledLinkedList &&other) noexcept
+        : head(other.head), tail(other.tail), count(other.count), alloc(other.alloc) {
+        other.head = other.tail = nullptr;
+        other.count = 0;
+    }
+
+    UnrolledLinkedList &operator=(UnrolledLinkedList &&other) noexcept {
+        if (this != &other) {
+            clear();
+            head = other.head;
+            tail = other.tail;
+            count = other.count;
+            alloc = other.alloc;
+            other.head = other.tail = nullptr;
+            other.count = 0;
+        }
+        return *this;
+    }
+
+    void push_front(const T &value) { emplace_front(value); }
+
+    void push_front(T &&value) { emplace_front(std::move(value)); }
+
+    template<typename... Args>
+    T &emplace_front(Args &&... args) {
+        if (!head || head->size == N) return *emplace_node_after(nullptr, std::forward<Args>(args)...)->items();
+        return *emplace_at(head, 0, std::forward<Args>(args)...);
+    }
+
+    void push_back(const T &value) { emplace_back(value); }
+
+    void push_back(T &&value) { emplace_back(std::move(value)); }
+
+    template<typename... Args>
+    T &emplace_back(Args &&... args) {
+        if (!tail || tail->size == N) return *emplace_node_after(tail, std::forward<Args>(args)...)->items();
+        return *emplace_at(tail, tail->size, std::forward<Args>(args)...);
+    }
+
+    T pop_front() {
+        if (!head) throw std::runtime_error("List is empty");
+        T value = std::move(head->items()[0]);
+        erase_at(head, 0);
+        return value;
+    }
+
+    T pop_back() {
+        if (!tail) throw std::runtime_error("List is empty");
+        T value = std::move(tail->items()[tail->size - 1]);
+        erase_at(tail, tail->size - 1);
+        return value;
+    }
+
+    T &front() {
+        if (!head) throw std::runtime_error("List is empty");
+        return head->items()[0];
+    }
+
+    T &back() {
+        if (!tail) throw std::runtime_error("List is empty");
+        return tail->items()[tail->size - 1];
+    }
+
+    bool contains(const T &value) const {
+        for (const Node *curr = head; curr; curr = curr->next) {
+            if (simd_find(curr->items(), curr->size, value) != curr->size) return true;
+        }
+        return false;
+    }
+
+    size_t count_of(const T &value) const {
+        size_t found = 0;
+        for (const Node *curr = head; curr; curr = curr->next) {
+            found += simd_count(curr->items(), curr->size, value);
+        }
+        return found;
+    }
+
+    bool remove(const T &value) {
+        for (Node *curr = head; curr; curr = curr->next) {
+            size_t i = simd_find(curr->items(), curr->size, value);
+            if (i != curr->size) {
+                erase_at(curr, i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void clear() {
+        while (head) {
+            Node *tmp = head;
+            head = head->next;
+            destroy_node(tmp);
+        }
+        tail = nullptr;
+        count = 0;
+    }
+
+    Alloc get_allocator() const { return Alloc(alloc); }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    static constexpr size_t node_capacity() { return N; }
+
+    class Iterator {
+        Node *node;
+        size_t idx;
+
+        friend class UnrolledLinkedList;
+
+    public:
+        Iterator(Node *n, size_t i = 0) : node(n), idx(i) {
+        }
+
+        T &operator*() { return node->items()[idx]; }
+
+        Iterator &operator++() {
+            if (++idx == node->size) {
+                node = node->next;
+                idx = 0;
+            }
+            return *this;
+        }
+
+        Iterator &operator--() {
+            if (idx == 0) {
+                node = node->prev;
+                idx = node->size;
+            }
+            --idx;
+            return *this;
+        }
+
+        bool operator!=(const Iterator &o) const { return node != o.node || idx != o.idx; }
+    };
+
+    class ReverseIterator {
+        Node *node;
+        size_t idx;
+
+    public:
+        ReverseIterator(Node *n, size_t i = 0) : node(n), idx(i) {
+        }
+
+        T &operator*() { return node->items()[idx]; }
+
+        ReverseIterator &operator++() {
+            if (idx == 0) {
+                node = node->prev;
+                idx = node ? node->size - 1 : 0;
+            } else {
+                --idx;
+            }
+            return *this;
+        }
+
+        bool operator!=(const ReverseIterator &o) const { return node != o.node || idx != o.idx; }
+    };
+
+    Iterator insert(Iterator pos, const T &value) { return emplace(pos, value); }
+
+    Iterator insert(Iterator pos, T &&value) { return emplace(pos, std::move(value)); }
+
+    // Constructs before `pos`, splitting its node when it is full.
+    template<typename... Args>
+    Iterator emplace(Iterator pos, Args &&... args) {
+        if (!pos.node) {
+            emplace_back(std::forward<Args>(args)...);
+            return Iterator(tail, tail->size - 1);
+        }
+
+        Node *node = pos.node;
+        size_t idx = pos.idx;
+        if (node->size == N) {
+            split(node);
+            if (idx > node->size) {
+                idx -= node->size;
+                node = node->next;
+            }
+        }
+        emplace_at(node, idx, std::forward<Args>(args)...);
+        return Iterator(node, idx);
+    }
+
+    Iterator find(const T &value) {
+        for (Node *curr = head; curr; curr = curr->next) {
+            size_t i = simd_find(curr->items(), curr->size, value);
+            if (i != curr->size) return Iterator(curr, i);
+        }
+        return end();
+    }
+
+    template<typename Pred>
+    Iterator find_if(Pred pred) {
+        for (Node *curr = head; curr; curr = curr->next) {
+            T *items = curr->items();
+            for (size_t i = 0; i < curr->size; ++i) {
+                if (pred(items[i])) return Iterator(curr, i);
+            }
+        }
+        return end();
+    }
+
+    Iterator erase(Iterator pos) {
+        auto [node, idx] = erase_at(pos.node, pos.idx);
+        return Iterator(node, idx);
+    }
+
+    Iterator begin() { return Iterator(head); }
+    Iterator end() { return Iterator(nullptr); }
+    ReverseIterator rbegin() { return tail ? ReverseIterator(tail, tail->size - 1) : rend(); }
+    ReverseIterator rend() { return ReverseIterator(nullptr); }
+};
+
+#endif //UNROLLED_LINKED_LIST_H
@@ -0,0 +1,179 @@
+﻿#ifndef WORK_STEALING_DEQUE_H
+#define WORK_STEALING_DEQUE_H
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+// Work-stealing deque after Chase & Lev (2005), with the C11 orderings of
+// Lê et al. (2013). One owner thread pushes and pops at the back without
+// locking; any number of thieves take from the front with a CAS on the
+// front index.
+//
+// Instead of one circular array that is copied when it fills, elements
+// live in a chain of fixed-size blocks. Indices only ever grow at the
+// front, so block i covers indices [base, base + BlockSize) and the chain
+// is extended at the back as needed. Blocks the front has moved past are
+// recycled to the back by the owner, never freed while the deque lives: a
+// thief that read a stale index may still look into one, but its CAS then
+// fails, so whatever it read is discarded. That is also why elements are
+// read through atomics and have to be trivially copyable; task pointers
+// are the intended payload.
+template<typename T, size_t BlockSize = 256>
+class WorkStealingDeque {
+    static_assert(std::is_trivially_copyable_v<T>, "elements are copied racily and must be trivially copyable");
+    static_assert(BlockSize > 0);
+
+    static constexpr size_t cache_line = 64;
+    static constexpr int64_t span = static_cast<int64_t>(BlockSize);
+
+    struct Block {
+        std::atomic<T> slots[BlockSize];
+        std::atomic<int64_t> base{0};
+        std::atomic<Block *> next{nullptr};
+        Block *prev = nullptr;
+    };
+
+    alignas(cache_line) std::atomic<int64_t> front{0};
+    // Block holding `front`, or one before it: thieves advance it lazily,
+    // and the owner recycles only blocks in front of it.
+    std::atomic<Block *> front_block;
+    alignas(cache_line) std::atomic<int64_t> back{0};
+    // Owner-only from here on.
+    Block *back_block;
+    Block *oldest;
+    Block *newest;
+
+    // Moves front_block forward to `to`, which must still start at
+    // `boundary`, the index the caller's CAS moved front to. Never moves it
+    // back: a thief that crossed an older boundary may publish after one
+    // that crossed a newer one. A publisher that stalled long enough for
+    // `to` to be recycled finds its base changed and gives up, so
+    // front_block never gets ahead of front.
+    void advance_front_block(Block *to, int64_t boundary) {
+        if (!to) return;
+        Block *current = front_block.load(std::memory_order_acquire);
+        while (current->base.load(std::memory_order_acquire) < boundary &&
+               to->base.load(std::memory_order_acquire) == boundary &&
+               !front_block.compare_exchange_weak(current, to, std::memory_order_acq_rel,
+                                                  std::memory_order_acquire)) {
+        }
+    }
+
+    // Appends a block after `newest`, reusing the oldest one when the front
+    // and back have both left it. The front index decides that; front_block
+    // only pins the block thieves may still start walking from.
+    void extend() {
+        Block *block;
+        if (oldest != back_block &&
+            front.load(std::memory_order_acquire) >= oldest->base.load(std::memory_order_relaxed) + span &&
+            oldest != front_block.load(std::memory_order_acquire)) {
+            block = oldest;
+            oldest = oldest->next.load(std::memory_order_relaxed);
+            oldest->prev = nullptr;
+        } else {
+            block = new Block;
+        }
+        block->next.store(nullptr, std::memory_order_relaxed);
+        block->prev = newest;
+        block->base.store(newest->base.load(std::memory_order_relaxed) + span, std::memory_order_relaxed);
+        newest->next.store(block, std::memory_order_release);
+        newest = block;
+    }
+
+public:
+    WorkStealingDeque() {
+        Block *block = new Block;
+        front_block.store(block, std::memory_order_relaxed);
+        back_block = oldest = newest = block;
+    }
+
+    // Must not race with any other operation.
+    ~WorkStealingDeque() {
+        for (Block *block = oldest; block;) {
+            Block *next = block->next.load(std::memory_order_relaxed);
+            delete block;
+            block = next;
+        }
+    }
+
+    WorkStealingDeque(const WorkStealingDeque &) = delete;
+
+    WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+    // Owner only.
+    void push_back(T value) {
+        const int64_t b = back.load(std::memory_order_relaxed);
+        if (b >= back_block->base.load(std::memory_order_relaxed) + span) {
+            if (back_block == newest) extend();
+            back_block = back_block->next.load(std::memory_order_relaxed);
+        }
+        back_block->slots[b - back_block->base.load(std::memory_order_relaxed)].store(value, std::memory_order_relaxed);
+        // Release pairs with the thief's acquire load of back, publishing the
+        // slot and whatever the task points at.
+        back.store(b + 1, std::memory_order_release);
+    }
+
+    // Owner only. The last element is contended with the thieves through
+    // the same CAS on front that they use.
+    std::optional<T> try_pop_back() {
+        const int64_t b = back.load(std::memory_order_relaxed) - 1;
+        back.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t f = front.load(std::memory_order_relaxed);
+        if (f > b) {
+            back.store(b + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        while (b < back_block->base.load(std::memory_order_relaxed)) back_block = back_block->prev;
+        Block *block = back_block;
+        const int64_t base = block->base.load(std::memory_order_relaxed);
+        T value = block->slots[b - base].load(std::memory_order_relaxed);
+        if (f == b) {
+            const bool won = front.compare_exchange_strong(f, f + 1, std::memory_order_seq_cst,
+                                                           std::memory_order_relaxed);
+            back.store(b + 1, std::memory_order_relaxed);
+            if (!won) return std::nullopt;
+            if (f + 1 == base + span) advance_front_block(block->next.load(std::memory_order_relaxed), f + 1);
+        }
+        return value;
+    }
+
+    // Any thread. Empty also when the front element went to another thread
+    // first; callers treat both as "nothing here right now".
+    std::optional<T> try_steal_front() {
+        int64_t f = front.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t b = back.load(std::memory_order_acquire);
+        if (f >= b) return std::nullopt;
+
+        Block *block = front_block.load(std::memory_order_acquire);
+        int64_t base = block->base.load(std::memory_order_acquire);
+        while (base + span <= f) {
+            block = block->next.load(std::memory_order_acquire);
+            if (!block) return std::nullopt;
+            base = block->base.load(std::memory_order_acquire);
+        }
+        if (base > f) return std::nullopt;
+
+        T value = block->slots[f - base].load(std::memory_order_relaxed);
+        if (!front.compare_exchange_strong(f, f + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return std::nullopt;
+        }
+        if (f + 1 == base + span) advance_front_block(block->next.load(std::memory_order_acquire), f + 1);
+        return value;
+    }
+
+    // Snapshots only, exact for the owner when no thief is active.
+    size_t size() const {
+        const int64_t f = front.load(std::memory_order_acquire);
+        const int64_t b = back.load(std::memory_order_acquire);
+        return b > f ? static_cast<size_t>(b - f) : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+};
+
+#endif //WORK_STEALING_DEQUE_H
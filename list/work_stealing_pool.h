@@ -0,0 +1,217 @@
+﻿#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "concurrent_queue.h"
+#include "work_stealing_deque.h"
+
+// Fork/join thread pool with one deque per worker. A task spawned on a
+// worker goes to the back of that worker's deque and is usually popped
+// right back by it; idle workers steal from the front of a random victim,
+// which hands them the oldest and typically largest piece of work. Tasks
+// spawned from outside the pool go through a shared ConcurrentQueue.
+// Workers that find nothing spin briefly, then sleep until new work is
+// pushed.
+//
+// Deque is the per-worker container: anything with push_back,
+// try_pop_back and try_steal_front, WorkStealingDeque by default.
+template<template<typename> class Deque = WorkStealingDeque>
+class WorkStealingPool {
+public:
+    // Counts the unfinished tasks of one fork/join scope. The first
+    // exception thrown by one of them is kept and rethrown by wait().
+    class TaskGroup {
+        std::atomic<size_t> pending{0};
+        std::once_flag failed;
+        std::exception_ptr error;
+
+        friend class WorkStealingPool;
+
+    public:
+        TaskGroup() = default;
+
+        TaskGroup(const TaskGroup &) = delete;
+
+        TaskGroup &operator=(const TaskGroup &) = delete;
+    };
+
+private:
+    struct Task {
+        TaskGroup *group;
+
+        explicit Task(TaskGroup *g) : group(g) {
+        }
+
+        virtual ~Task() = default;
+
+        virtual void run() = 0;
+    };
+
+    template<typename F>
+    struct Job : Task {
+        F fn;
+
+        Job(TaskGroup *g, F &&f) : Task(g), fn(std::move(f)) {
+        }
+
+        void run() override { fn(); }
+    };
+
+    struct alignas(64) Worker {
+        Deque<Task *> tasks;
+    };
+
+    static constexpr int spins_before_sleep = 64;
+
+    size_t worker_count;
+    std::unique_ptr<Worker[]> workers;
+    ConcurrentQueue<Task *> injected;
+    std::atomic<bool> stopping{false};
+    std::atomic<uint32_t> epoch{0};
+    std::atomic<uint32_t> sleepers{0};
+    std::vector<std::thread> threads;
+
+    static inline thread_local WorkStealingPool *current_pool = nullptr;
+    static inline thread_local size_t current_index = 0;
+
+    // Index of the calling worker, or worker_count for outside threads.
+    size_t self() const { return current_pool == this ? current_index : worker_count; }
+
+    Task *find_task(size_t me, uint32_t &seed) {
+        if (me < worker_count) {
+            if (auto task = workers[me].tasks.try_pop_back()) return *task;
+        }
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        const size_t start = seed % worker_count;
+        for (size_t i = 0; i < worker_count; ++i) {
+            const size_t victim = (start + i) % worker_count;
+            if (victim == me) continue;
+            if (auto task = workers[victim].tasks.try_steal_front()) return *task;
+        }
+        if (auto task = injected.try_pop_front()) return *task;
+        return nullptr;
+    }
+
+    static void execute(Task *task) {
+        TaskGroup *group = task->group;
+        try {
+            task->run();
+        } catch (...) {
+            std::call_once(group->failed, [group] { group->error = std::current_exception(); });
+        }
+        delete task;
+        // Last touch of the group: wait() may return and destroy it now.
+        group->pending.fetch_sub(1, std::memory_order_release);
+    }
+
+    // Pairs with the sleeper's fetch_add on sleepers and rescan: either this
+    // sees the sleeper, or the sleeper's rescan sees the new task.
+    void wake() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_relaxed)) {
+            epoch.fetch_add(1, std::memory_order_release);
+            epoch.notify_one();
+        }
+    }
+
+    void work(size_t index) {
+        current_pool = this;
+        current_index = index;
+        uint32_t seed = static_cast<uint32_t>(index) * 2654435761u + 1;
+        int idle = 0;
+        while (!stopping.load(std::memory_order_acquire)) {
+            if (Task *task = find_task(index, seed)) {
+                execute(task);
+                idle = 0;
+            } else if (++idle < spins_before_sleep) {
+                std::this_thread::yield();
+            } else {
+                sleepers.fetch_add(1, std::memory_order_seq_cst);
+                const uint32_t seen = epoch.load(std::memory_order_seq_cst);
+                Task *task = find_task(index, seed);
+                if (!task && !stopping.load(std::memory_order_acquire)) epoch.wait(seen, std::memory_order_acquire);
+                sleepers.fetch_sub(1, std::memory_order_relaxed);
+                if (task) execute(task);
+                idle = 0;
+            }
+        }
+    }
+
+public:
+    // 0 threads means hardware_concurrency().
+    explicit WorkStealingPool(size_t thread_count = 0)
+        : worker_count(thread_count ? thread_count : std::max(1u, std::thread::hardware_concurrency())),
+          workers(new Worker[worker_count]) {
+        threads.reserve(worker_count);
+        try {
+            for (size_t i = 0; i < worker_count; ++i) threads.emplace_back(&WorkStealingPool::work, this, i);
+        } catch (...) {
+            stop();
+            throw;
+        }
+    }
+
+    // Groups still in flight must have been waited for.
+    ~WorkStealingPool() { stop(); }
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    size_t size() const { return worker_count; }
+
+    // Forks f() as part of group. From a worker this is a push onto its own
+    // deque, with no lock and no shared write.
+    template<typename F>
+    void spawn(TaskGroup &group, F f) {
+        Task *task = new Job<F>(&group, std::move(f));
+        group.pending.fetch_add(1, std::memory_order_relaxed);
+        try {
+            if (size_t me = self(); me < worker_count) workers[me].tasks.push_back(task);
+            else injected.push_back(task);
+        } catch (...) {
+            group.pending.fetch_sub(1, std::memory_order_relaxed);
+            delete task;
+            throw;
+        }
+        wake();
+    }
+
+    // Joins group. The caller runs queued tasks, its own first, until every
+    // task of the group has finished, so a worker never blocks on its own
+    // children.
+    void wait(TaskGroup &group) {
+        const size_t me = self();
+        uint32_t seed = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&group) >> 4) | 1;
+        while (group.pending.load(std::memory_order_acquire)) {
+            if (Task *task = find_task(me, seed)) execute(task);
+            else std::this_thread::yield();
+        }
+        if (group.error) std::rethrow_exception(std::exchange(group.error, nullptr));
+    }
+
+private:
+    void stop() {
+        stopping.store(true, std::memory_order_release);
+        epoch.fetch_add(1, std::memory_order_release);
+        epoch.notify_all();
+        for (std::thread &thread: threads) thread.join();
+        threads.clear();
+        for (size_t i = 0; i < worker_count; ++i) {
+            while (auto task = workers[i].tasks.try_pop_back()) delete *task;
+        }
+        while (auto task = injected.try_pop_front()) delete *task;
+    }
+};
+
+#endif //WORK_STEALING_POOL_H
@@ -1,21 +1,92 @@
 ﻿#ifndef XOR_LINKED_LIST_H
 #define XOR_LINKED_LIST_H
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <ranges>
 #include <stdexcept>
-
-template<typename T>
+#include <type_traits>
+#include <utility>
+#include "../algorithm/prefetch.h"
+#include "../algorithm/sort.cpp"
+#include "../algorithm/traits.h"
+#include "../memory/node_blocks.h"
+#include "list_stats.h"
+
+template<typename T, typename Alloc = std::allocator<T>, typename Prefetch = NoPrefetch, typename Stats = NoStats>
 class XORLinkedList {
 private:
     struct Node {
         T data;
         Node *npx;
+        [[no_unique_address]] JumpLink<Node, prefetch_enabled_v<Prefetch> > link;
 
-        Node(const T &val) : data(val), npx(nullptr) {
+        template<typename... Args>
+        explicit Node(Args &&... args) : data(std::forward<Args>(args)...), npx(nullptr) {
         }
     };
 
+    using NodeAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAlloc>;
+
     Node *head = nullptr;
     Node *tail = nullptr;
     size_t count = 0;
+    [[no_unique_address]] NodeAlloc alloc;
+    NodeBlocks<Node, NodeAlloc> blocks;
+    [[no_unique_address]] mutable Stats recorder;
+
+    template<typename... Args>
+    Node *create_node(Args &&... args) {
+        Node *node = NodeTraits::allocate(alloc, 1);
+        try {
+            NodeTraits::construct(alloc, node, std::forward<Args>(args)...);
+        } catch (...) {
+            NodeTraits::deallocate(alloc, node, 1);
+            throw;
+        }
+        recorder.on_allocate();
+        return node;
+    }
+
+    void destroy_node(Node *node) {
+        NodeTraits::destroy(alloc, node);
+        recorder.on_free();
+        if (!blocks.release(alloc, node)) NodeTraits::deallocate(alloc, node, 1);
+    }
+
+    // Nodes unlinked by a bulk removal are chained through npx, which then
+    // holds a plain pointer rather than an XOR of two.
+    void free_chain(Node *node) {
+        while (node) {
+            Node *next = node->npx;
+            destroy_node(node);
+            node = next;
+        }
+    }
+
+    // The automatic trigger swallows a failed compaction, which leaves the
+    // list as it was.
+    void maybe_compact() {
+        if (!blocks.due(count) || fragmentation() <= blocks.threshold()) return;
+        try {
+            compact();
+        } catch (...) {
+        }
+    }
+
+    bool release_nodes() {
+        if constexpr (has_release_v<NodeAlloc> && std::is_trivially_destructible_v<T>) {
+            if (alloc.live() == count && blocks.empty()) {
+                recorder.on_free(count);
+                alloc.release();
+                return true;
+            }
+        }
+        return false;
+    }
 
     static Node *XOR(Node *a, Node *b) {
         return reinterpret_cast<Node *>(
@@ -23,9 +94,73 @@ private:
         );
     }
 
+    // Copies [first, last) into a detached list in a single linking pass;
+    // tail and count are written once at the end.
+    template<typename It, typename S>
+    XORLinkedList chain_of(It first, S last) {
+        XORLinkedList chain(get_allocator());
+        Node *prev = nullptr;
+        size_t n = 0;
+        for (; first != last; ++first, ++n) {
+            Node *node = create_node(*first);
+            node->npx = prev;
+            if (prev) prev->npx = XOR(prev->npx, node);
+            else chain.head = node;
+            prev = node;
+        }
+        chain.tail = prev;
+        chain.count = n;
+        return chain;
+    }
+
+    // Moves chain's nodes in between the adjacent nodes prev and next;
+    // either is null at the corresponding end.
+    void link_between(Node *prev, Node *next, XORLinkedList &chain) {
+        if (!chain.head) return;
+        Node *first = chain.head;
+        Node *last = chain.tail;
+
+        first->npx = XOR(first->npx, prev);
+        last->npx = XOR(last->npx, next);
+        if (prev) prev->npx = XOR(XOR(prev->npx, next), first);
+        else head = first;
+        if (next) next->npx = XOR(XOR(next->npx, prev), last);
+        else tail = last;
+
+        count += chain.count;
+        chain.head = chain.tail = nullptr;
+        chain.count = 0;
+    }
+
+    void append_chain(XORLinkedList &&chain) { link_between(tail, nullptr, chain); }
+
 public:
+    using value_type = T;
+    using reference = T &;
+    using const_reference = const T &;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using allocator_type = Alloc;
+
     XORLinkedList() = default;
 
+    explicit XORLinkedList(const Alloc &a) : alloc(a) {
+    }
+
+    template<std::input_iterator It, std::sentinel_for<It> S>
+    XORLinkedList(It first, S last, const Alloc &a = Alloc()) : alloc(a) {
+        append_chain(chain_of(std::move(first), std::move(last)));
+    }
+
+    // Builds a list from any input range, reading it exactly once, so
+    // generators and istream views need no intermediate buffer.
+    template<std::ranges::input_range R>
+    static XORLinkedList from_stream(R &&input, const Alloc &a = Alloc()) {
+        XORLinkedList list(a);
+        list.append_range(std::forward<R>(input));
+        return list;
+    }
+
     ~XORLinkedList() {
         clear();
     }
@@ -35,7 +170,8 @@ public:
     XORLinkedList &operator=(const XORLinkedList &) = delete;
 
     XORLinkedList(XORLinkedList &&other) noexcept
-        : head(other.head), tail(other.tail), count(other.count) {
+        : head(other.head), tail(other.tail), count(other.count), alloc(other.alloc),
+          blocks(std::move(other.blocks)) {
         other.head = other.tail = nullptr;
         other.count = 0;
     }
@@ -46,14 +182,21 @@ public:
             head = other.head;
             tail = other.tail;
             count = other.count;
+            alloc = other.alloc;
+            blocks = std::move(other.blocks);
             other.head = other.tail = nullptr;
             other.count = 0;
         }
         return *this;
     }
 
-    void push_front(const T &value) {
-        Node *node = new Node(value);
+    void push_front(const T &value) { emplace_front(value); }
+
+    void push_front(T &&value) { emplace_front(std::move(value)); }
+
+    template<typename... Args>
+    T &emplace_front(Args &&... args) {
+        Node *node = create_node(std::forward<Args>(args)...);
         node->npx = head;
 
         if (head) {
@@ -63,10 +206,18 @@ public:
         }
         head = node;
         ++count;
+        recorder.on_push();
+        maybe_compact();
+        return head->data;
     }
 
-    void push_back(const T &value) {
-        Node *node = new Node(value);
+    void push_back(const T &value) { emplace_back(value); }
+
+    void push_back(T &&value) { emplace_back(std::move(value)); }
+
+    template<typename... Args>
+    T &emplace_back(Args &&... args) {
+        Node *node = create_node(std::forward<Args>(args)...);
         node->npx = tail;
 
         if (tail) {
@@ -76,13 +227,16 @@ public:
         }
         tail = node;
         ++count;
+        recorder.on_push();
+        maybe_compact();
+        return tail->data;
     }
 
     T pop_front() {
         if (!head) throw std::runtime_error("List is empty");
 
         Node *node = head;
-        T value = node->data;
+        T value = std::move(node->data);
         Node *next = node->npx;
 
         if (next) {
@@ -91,8 +245,10 @@ public:
             tail = nullptr;
         }
         head = next;
-        delete node;
+        destroy_node(node);
         --count;
+        recorder.on_pop();
+        maybe_compact();
         return value;
     }
 
@@ -100,7 +256,7 @@ public:
         if (!tail) throw std::runtime_error("List is empty");
 
         Node *node = tail;
-        T value = node->data;
+        T value = std::move(node->data);
         Node *prev = node->npx;
 
         if (prev) {
@@ -109,8 +265,10 @@ public:
             head = nullptr;
         }
         tail = prev;
-        delete node;
+        destroy_node(node);
         --count;
+        recorder.on_pop();
+        maybe_compact();
         return value;
     }
 
@@ -125,24 +283,37 @@ public:
     }
 
     bool contains(const T &value) const {
+        JumpWindow<Node, Prefetch> window;
+        size_t visited = 0;
         Node *curr = head;
         Node *prev = nullptr;
 
         while (curr) {
-            if (curr->data == value) return true;
+            window.visit(curr);
+            ++visited;
+            if (curr->data == value) {
+                recorder.on_contains(visited);
+                return true;
+            }
             Node *next = XOR(prev, curr->npx);
             prev = curr;
             curr = next;
         }
+        recorder.on_contains(visited);
         return false;
     }
 
     bool remove(const T &value) {
+        JumpWindow<Node, Prefetch> window;
+        size_t visited = 0;
         Node *curr = head;
         Node *prev = nullptr;
 
         while (curr) {
+            window.visit(curr);
+            ++visited;
             if (curr->data == value) {
+                recorder.on_remove(visited);
                 Node *next = XOR(prev, curr->npx);
 
                 if (prev) {
@@ -157,58 +328,261 @@ public:
                     tail = prev;
                 }
 
-                delete curr;
+                destroy_node(curr);
                 --count;
+                maybe_compact();
                 return true;
             }
             Node *next = XOR(prev, curr->npx);
             prev = curr;
             curr = next;
         }
+        recorder.on_remove(visited);
         return false;
     }
 
+    // Single-pass removal of every element satisfying pred. Each unlink
+    // rewrites the npx of both neighbours, as remove() does, so the list
+    // stays consistent throughout; the nodes are freed together at the end.
+    template<typename Pred>
+    size_t remove_if(Pred pred) {
+        JumpWindow<Node, Prefetch> window;
+        Node *dead = nullptr;
+        size_t removed = 0;
+        try {
+            Node *prev = nullptr;
+            for (Node *curr = head, *next; curr; curr = next) {
+                window.visit(curr);
+                next = XOR(prev, curr->npx);
+                if (!pred(curr->data)) {
+                    prev = curr;
+                    continue;
+                }
+                if (prev) prev->npx = XOR(XOR(prev->npx, curr), next);
+                else head = next;
+                if (next) next->npx = XOR(prev, XOR(curr, next->npx));
+                else tail = prev;
+                curr->npx = dead;
+                dead = curr;
+                --count;
+                ++removed;
+            }
+        } catch (...) {
+            free_chain(dead);
+            throw;
+        }
+        free_chain(dead);
+        if (removed) maybe_compact();
+        return removed;
+    }
+
+    size_t remove_all(const T &value) {
+        return remove_if([&value](const T &x) { return x == value; });
+    }
+
+    // Keeps the first of every run of equal neighbours, so a sorted list
+    // ends up with each value once. Returns the number removed.
+    template<typename Eq = std::equal_to<> >
+    size_t unique(Eq eq = {}) {
+        const T *kept = nullptr;
+        return remove_if([&](const T &x) {
+            if (kept && eq(*kept, x)) return true;
+            kept = &x;
+            return false;
+        });
+    }
+
+    // Removes every element contained in values, a std::set, an
+    // unordered_set or anything else with contains().
+    template<typename Set>
+        requires requires(const Set &s, const T &v) { { s.contains(v) } -> std::convertible_to<bool>; }
+    size_t erase(const Set &values) {
+        return remove_if([&values](const T &x) { return values.contains(x); });
+    }
+
     void clear() {
-        Node *curr = head;
+        Node *curr = release_nodes() ? nullptr : head;
         Node *prev = nullptr;
 
         while (curr) {
+            JumpWindow<Node, Prefetch>::follow(curr);
             Node *next = XOR(prev, curr->npx);
             prev = curr;
-            delete curr;
+            destroy_node(curr);
             curr = next;
         }
         head = tail = nullptr;
         count = 0;
+        blocks.reset();
+    }
+
+    // Moves the elements into one new array of nodes, in list order, and
+    // relinks them. Invalidates iterators and references. Values are copied
+    // only if moving T can throw; a failure then leaves the list unchanged.
+    void compact() {
+        if (!head) return;
+        Node *fresh = blocks.allocate(alloc, count);
+        size_t built = 0;
+        try {
+            Node *prev = nullptr;
+            for (Node *curr = head; curr;) {
+                NodeTraits::construct(alloc, fresh + built, std::move_if_noexcept(curr->data));
+                // npx of the new node holds the old one until it is freed.
+                fresh[built++].npx = curr;
+                Node *next = XOR(prev, curr->npx);
+                prev = curr;
+                curr = next;
+            }
+        } catch (...) {
+            while (built) NodeTraits::destroy(alloc, fresh + --built);
+            blocks.abandon(alloc, fresh);
+            throw;
+        }
+        recorder.on_compact();
+        recorder.on_allocate(count);
+        for (size_t i = 0; i < count; ++i) {
+            destroy_node(fresh[i].npx);
+            fresh[i].npx = XOR(i ? fresh + i - 1 : nullptr, i + 1 < count ? fresh + i + 1 : nullptr);
+        }
+        head = fresh;
+        tail = fresh + count - 1;
+    }
+
+    // Share of links, from 0 to 1, between nodes more than a few cache
+    // lines apart. Walks the whole list.
+    double fragmentation() const {
+        if (count < 2) return 0;
+        size_t far = 0;
+        Node *prev = nullptr;
+        for (Node *curr = head; curr != tail;) {
+            Node *next = XOR(prev, curr->npx);
+            far += nodes_far_apart(curr, next);
+            prev = curr;
+            curr = next;
+        }
+        return static_cast<double>(far) / static_cast<double>(count - 1);
+    }
+
+    // Compacts automatically once fragmentation() exceeds fraction; 0 turns
+    // it off. Checked after about size() pushes, pops and removes, any of
+    // which may then invalidate iterators.
+    void set_compaction_threshold(double fraction) { blocks.set_threshold(fraction); }
+
+    Stats stats() const { return recorder; }
+
+    void reset_stats() { recorder = Stats(); }
+
+    // Stable in-place merge sort; allocates nothing and moves no elements.
+    template<typename Compare = std::less<> >
+    void sort(Compare comp = {}) {
+        head = merge_sort(head, comp, &tail);
     }
 
+    Alloc get_allocator() const { return Alloc(alloc); }
+
     size_t size() const { return count; }
     bool empty() const { return count == 0; }
 
-    class Iterator {
-        Node *curr;
-        Node *prev;
+    template<bool Const>
+    class BasicIterator {
+        Node *curr = nullptr;
+        Node *prev = nullptr;
+
+        friend class XORLinkedList;
+        friend class BasicIterator<!Const>;
 
     public:
-        Iterator(Node *c, Node *p) : curr(c), prev(p) {
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T *, T *>;
+        using reference = std::conditional_t<Const, const T &, T &>;
+
+        BasicIterator() = default;
+
+        BasicIterator(Node *c, Node *p) : curr(c), prev(p) {
+        }
+
+        template<bool C = Const> requires C
+        BasicIterator(const BasicIterator<false> &o) : curr(o.curr), prev(o.prev) {
         }
 
-        T &operator*() { return curr->data; }
+        reference operator*() const { return curr->data; }
+        pointer operator->() const { return &curr->data; }
 
-        Iterator &operator++() {
+        BasicIterator &operator++() {
             Node *next = XOR(prev, curr->npx);
             prev = curr;
             curr = next;
             return *this;
         }
 
-        bool operator!=(const Iterator &other) const {
-            return curr != other.curr;
+        BasicIterator operator++(int) {
+            BasicIterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        // end() remembers the tail, so it can be decremented too.
+        BasicIterator &operator--() {
+            Node *before = XOR(curr, prev->npx);
+            curr = prev;
+            prev = before;
+            return *this;
+        }
+
+        BasicIterator operator--(int) {
+            BasicIterator old = *this;
+            --*this;
+            return old;
+        }
+
+        bool operator==(const BasicIterator &other) const {
+            return curr == other.curr;
         }
     };
 
+    using Iterator = BasicIterator<false>;
+    using ConstIterator = BasicIterator<true>;
+    using iterator = Iterator;
+    using const_iterator = ConstIterator;
+
+    // Replaces the contents. The new nodes are built before the old ones
+    // are freed, so a throwing element constructor leaves the list intact.
+    template<std::input_iterator It, std::sentinel_for<It> S>
+    void assign(It first, S last) {
+        XORLinkedList chain = chain_of(std::move(first), std::move(last));
+        clear();
+        append_chain(std::move(chain));
+    }
+
+    template<std::ranges::input_range R>
+    void assign_range(R &&range) { assign(std::ranges::begin(range), std::ranges::end(range)); }
+
+    // The *_range members link the new nodes in one pass and update the
+    // size once.
+    template<std::ranges::input_range R>
+    void append_range(R &&range) { append_chain(chain_of(std::ranges::begin(range), std::ranges::end(range))); }
+
+    template<std::ranges::input_range R>
+    void prepend_range(R &&range) {
+        XORLinkedList chain = chain_of(std::ranges::begin(range), std::ranges::end(range));
+        link_between(nullptr, head, chain);
+    }
+
+    // Inserts the range before pos.
+    template<std::ranges::input_range R>
+    void insert_range(Iterator pos, R &&range) {
+        XORLinkedList chain = chain_of(std::ranges::begin(range), std::ranges::end(range));
+        link_between(pos.prev, pos.curr, chain);
+    }
+
     Iterator begin() { return Iterator(head, nullptr); }
     Iterator end() { return Iterator(nullptr, tail); }
+    ConstIterator begin() const { return ConstIterator(head, nullptr); }
+    ConstIterator end() const { return ConstIterator(nullptr, tail); }
+    ConstIterator cbegin() const { return begin(); }
+    ConstIterator cend() const { return end(); }
 };
 
 #endif //XOR_LINKED_LIST_H
@@ -0,0 +1,136 @@
+﻿#ifndef HAZARD_POINTERS_H
+#define HAZARD_POINTERS_H
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Hazard pointers (Michael, 2004) for lock-free containers. A thread that
+// is about to dereference a shared node publishes it in one of its slots;
+// retired nodes are only freed once no slot in the domain points at them.
+// Records are recycled between operations rather than bound to threads.
+class HazardPointerDomain {
+public:
+    static constexpr size_t slots_per_record = 2;
+
+private:
+    struct Retired {
+        void *ptr;
+        void (*deleter)(void *);
+    };
+
+    struct Record {
+        std::atomic<void *> hazards[slots_per_record] = {};
+        std::atomic<bool> active{false};
+        Record *next = nullptr;
+        std::vector<Retired> retired;
+    };
+
+    std::atomic<Record *> records{nullptr};
+    std::atomic<size_t> record_count{0};
+
+    Record *acquire() {
+        for (Record *r = records.load(std::memory_order_acquire); r; r = r->next) {
+            bool expected = false;
+            if (!r->active.load(std::memory_order_relaxed) &&
+                r->active.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return r;
+            }
+        }
+
+        Record *r = new Record;
+        r->active.store(true, std::memory_order_relaxed);
+        Record *old = records.load(std::memory_order_relaxed);
+        do {
+            r->next = old;
+        } while (!records.compare_exchange_weak(old, r, std::memory_order_release, std::memory_order_relaxed));
+        record_count.fetch_add(1, std::memory_order_relaxed);
+        return r;
+    }
+
+    static void release(Record *r) {
+        for (auto &hazard: r->hazards) hazard.store(nullptr, std::memory_order_release);
+        r->active.store(false, std::memory_order_release);
+    }
+
+    // Frees every node retired by `self` that no slot currently protects.
+    void scan(Record *self) {
+        std::vector<void *> protected_ptrs;
+        for (Record *r = records.load(std::memory_order_acquire); r; r = r->next) {
+            for (auto &hazard: r->hazards) {
+                if (void *p = hazard.load(std::memory_order_seq_cst)) protected_ptrs.push_back(p);
+            }
+        }
+        std::sort(protected_ptrs.begin(), protected_ptrs.end());
+
+        auto keep = std::partition(self->retired.begin(), self->retired.end(), [&](const Retired &r) {
+            return std::binary_search(protected_ptrs.begin(), protected_ptrs.end(), r.ptr);
+        });
+        for (auto it = keep; it != self->retired.end(); ++it) it->deleter(it->ptr);
+        self->retired.erase(keep, self->retired.end());
+    }
+
+public:
+    HazardPointerDomain() = default;
+
+    HazardPointerDomain(const HazardPointerDomain &) = delete;
+
+    HazardPointerDomain &operator=(const HazardPointerDomain &) = delete;
+
+    // Only safe once no thread is inside an operation on this domain.
+    ~HazardPointerDomain() {
+        Record *r = records.load(std::memory_order_acquire);
+        while (r) {
+            for (Retired &retired: r->retired) retired.deleter(retired.ptr);
+            Record *next = r->next;
+            delete r;
+            r = next;
+        }
+    }
+
+    // Holds one record for the duration of a single container operation.
+    class Guard {
+        HazardPointerDomain &domain;
+        Record *record;
+
+    public:
+        explicit Guard(HazardPointerDomain &d) : domain(d), record(d.acquire()) {
+        }
+
+        ~Guard() { release(record); }
+
+        Guard(const Guard &) = delete;
+
+        Guard &operator=(const Guard &) = delete;
+
+        // Publishes the current value of `src` in `slot` and returns it once
+        // it is known to have still been reachable after publication.
+        template<typename P>
+        P *protect(size_t slot, const std::atomic<P *> &src) {
+            P *p = src.load(std::memory_order_relaxed);
+            while (true) {
+                record->hazards[slot].store(p, std::memory_order_seq_cst);
+                P *again = src.load(std::memory_order_seq_cst);
+                if (again == p) return p;
+                p = again;
+            }
+        }
+
+        void set(size_t slot, void *p) {
+            record->hazards[slot].store(p, std::memory_order_seq_cst);
+        }
+
+        void clear() {
+            for (auto &hazard: record->hazards) hazard.store(nullptr, std::memory_order_release);
+        }
+
+        // Hands an unlinked node to the domain; it is freed by a later scan.
+        void retire(void *p, void (*deleter)(void *)) {
+            record->retired.push_back({p, deleter});
+            size_t threshold = 64 + 2 * slots_per_record * domain.record_count.load(std::memory_order_relaxed);
+            if (record->retired.size() >= threshold) domain.scan(record);
+        }
+    };
+};
+
+#endif //HAZARD_POINTERS_H
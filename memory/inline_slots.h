@@ -0,0 +1,65 @@
+﻿#ifndef INLINE_SLOTS_H
+#define INLINE_SLOTS_H
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+// Room for N nodes inside the owning list object, so that short lists never
+// touch the allocator. One bit per slot marks it in use, which caps N at
+// 64. Slots are tied to the object's address: a list that hands nodes to
+// another object has to move them out of here first.
+template<typename Node, size_t N>
+class InlineSlots {
+    static_assert(N <= 64, "at most 64 inline nodes");
+
+    static constexpr uint64_t full = N == 64 ? ~uint64_t{0} : (uint64_t{1} << N) - 1;
+
+    alignas(Node) std::byte storage[N * sizeof(Node)];
+    uint64_t used = 0;
+
+    size_t index(const Node *p) const {
+        return (reinterpret_cast<const std::byte *>(p) - storage) / sizeof(Node);
+    }
+
+public:
+    InlineSlots() = default;
+
+    InlineSlots(const InlineSlots &) = delete;
+
+    InlineSlots &operator=(const InlineSlots &) = delete;
+
+    // Uninitialized storage for one node, or null when every slot is taken.
+    Node *allocate() {
+        if (used == full) return nullptr;
+        size_t i = std::countr_one(used);
+        used |= uint64_t{1} << i;
+        return reinterpret_cast<Node *>(storage + i * sizeof(Node));
+    }
+
+    void release(Node *p) { used &= ~(uint64_t{1} << index(p)); }
+
+    bool owns(const Node *p) const {
+        auto offset = reinterpret_cast<uintptr_t>(p) - reinterpret_cast<uintptr_t>(storage);
+        return offset < sizeof(storage);
+    }
+
+    size_t live() const { return std::popcount(used); }
+    size_t available() const { return N - live(); }
+    bool empty() const { return used == 0; }
+};
+
+template<typename Node>
+class InlineSlots<Node, 0> {
+public:
+    Node *allocate() { return nullptr; }
+
+    void release(Node *) {
+    }
+
+    bool owns(const Node *) const { return false; }
+    size_t live() const { return 0; }
+    size_t available() const { return 0; }
+    bool empty() const { return true; }
+};
+
+#endif //INLINE_SLOTS_H
@@ -0,0 +1,229 @@
+﻿#ifndef LIST_IMAGE_H
+#define LIST_IMAGE_H
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// File image of a singly or doubly linked list of trivially copyable
+// values: a header followed by fixed-size node records. Links are byte
+// offsets from the start of the image (0 is null), so the file can be
+// mapped at any address and walked in place.
+struct ListImageHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t value_size;
+    uint64_t value_align;
+    uint64_t node_size;
+    uint64_t count;
+    uint64_t head;
+    uint64_t tail;
+    // One past the last node record; appends go here.
+    uint64_t end;
+};
+
+inline constexpr char list_image_magic[8] = {'L', 'L', 'I', 'M', 'A', 'G', 'E', '\0'};
+inline constexpr uint32_t list_image_version = 1;
+inline constexpr uint32_t list_image_doubly = 1;
+
+template<typename T, bool Doubly>
+struct ListImageNode;
+
+template<typename T>
+struct ListImageNode<T, false> {
+    T value;
+    uint64_t next;
+};
+
+template<typename T>
+struct ListImageNode<T, true> {
+    T value;
+    uint64_t next;
+    uint64_t prev;
+};
+
+template<typename T, bool Doubly>
+inline constexpr uint64_t list_image_data_offset =
+        (sizeof(ListImageHeader) + alignof(ListImageNode<T, Doubly>) - 1) & ~(alignof(ListImageNode<T, Doubly>) - 1);
+
+// Streams `count` values into a fresh image. The file is written next to
+// `path` and renamed over it by finish(), so a mapping of the old file
+// stays intact.
+template<typename T, bool Doubly>
+class ListImageWriter {
+    static_assert(std::is_trivially_copyable_v<T>, "list images need trivially copyable values");
+
+    using Node = ListImageNode<T, Doubly>;
+
+    std::string path;
+    std::string temp;
+    FILE *file = nullptr;
+    uint64_t count;
+    uint64_t written = 0;
+
+    [[noreturn]] void fail(const char *what) {
+        int err = errno;
+        if (file) std::fclose(file);
+        file = nullptr;
+        std::remove(temp.c_str());
+        throw std::system_error(err, std::generic_category(), std::string(what) + " " + temp);
+    }
+
+    static uint64_t offset_of(uint64_t i) { return list_image_data_offset<T, Doubly> + i * sizeof(Node); }
+
+public:
+    ListImageWriter(std::string p, uint64_t n) : path(std::move(p)), temp(path + ".tmp"), count(n) {
+        file = std::fopen(temp.c_str(), "wb");
+        if (!file) fail("cannot create");
+        std::setvbuf(file, nullptr, _IOFBF, size_t{1} << 20);
+
+        ListImageHeader header{};
+        std::memcpy(header.magic, list_image_magic, sizeof(header.magic));
+        header.version = list_image_version;
+        header.flags = Doubly ? list_image_doubly : 0;
+        header.value_size = sizeof(T);
+        header.value_align = alignof(T);
+        header.node_size = sizeof(Node);
+        header.count = count;
+        header.head = count ? offset_of(0) : 0;
+        header.tail = count ? offset_of(count - 1) : 0;
+        header.end = offset_of(count);
+
+        unsigned char pad[list_image_data_offset<T, Doubly>] = {};
+        std::memcpy(pad, &header, sizeof(header));
+        if (std::fwrite(pad, sizeof(pad), 1, file) != 1) fail("cannot write");
+    }
+
+    ~ListImageWriter() {
+        if (file) {
+            std::fclose(file);
+            std::remove(temp.c_str());
+        }
+    }
+
+    ListImageWriter(const ListImageWriter &) = delete;
+
+    ListImageWriter &operator=(const ListImageWriter &) = delete;
+
+    // Records are written in list order, each linked to its neighbours.
+    void write(const T &value) {
+        if (written == count) throw std::logic_error("More values than announced");
+        Node node{};
+        std::memcpy(static_cast<void *>(&node.value), &value, sizeof(T));
+        node.next = written + 1 < count ? offset_of(written + 1) : 0;
+        if constexpr (Doubly) node.prev = written ? offset_of(written - 1) : 0;
+        if (std::fwrite(&node, sizeof(node), 1, file) != 1) fail("cannot write");
+        ++written;
+    }
+
+    void finish() {
+        if (written != count) throw std::logic_error("Fewer values than announced");
+        if (std::fflush(file) != 0 || ::fsync(::fileno(file)) != 0) fail("cannot flush");
+        if (std::fclose(file) != 0) {
+            file = nullptr;
+            fail("cannot close");
+        }
+        file = nullptr;
+        if (std::rename(temp.c_str(), path.c_str()) != 0) fail("cannot rename");
+    }
+};
+
+enum class MapMode {
+    // PROT_READ mapping; the list cannot change.
+    read_only,
+    // Private writable mapping followed by reserved anonymous memory.
+    // Changes and appends stay in memory and never reach the file.
+    copy_on_write
+};
+
+// mmap of a whole file, optionally extended by `reserve` bytes of
+// anonymous address space directly after it.
+class MappedRegion {
+    std::byte *base = nullptr;
+    size_t length = 0;
+    size_t file_bytes = 0;
+
+public:
+    MappedRegion(const std::string &path, MapMode mode, size_t reserve) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), "cannot open " + path);
+
+        struct stat st{};
+        if (::fstat(fd, &st) != 0) {
+            int err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(), "cannot stat " + path);
+        }
+        file_bytes = static_cast<size_t>(st.st_size);
+        if (file_bytes < sizeof(ListImageHeader)) {
+            ::close(fd);
+            throw std::runtime_error("Not a list image: " + path);
+        }
+
+        const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        const size_t file_span = (file_bytes + page - 1) & ~(page - 1);
+        void *addr;
+        if (mode == MapMode::read_only) {
+            length = file_span;
+            addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        } else {
+            length = file_span + ((reserve + page - 1) & ~(page - 1));
+            addr = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                          -1, 0);
+            if (addr != MAP_FAILED &&
+                ::mmap(addr, file_span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+                int err = errno;
+                ::munmap(addr, length);
+                errno = err;
+                addr = MAP_FAILED;
+            }
+        }
+        int err = errno;
+        ::close(fd);
+        if (addr == MAP_FAILED) throw std::system_error(err, std::generic_category(), "cannot map " + path);
+        base = static_cast<std::byte *>(addr);
+    }
+
+    ~MappedRegion() {
+        if (base) ::munmap(base, length);
+    }
+
+    MappedRegion(const MappedRegion &) = delete;
+
+    MappedRegion &operator=(const MappedRegion &) = delete;
+
+    MappedRegion(MappedRegion &&other) noexcept
+        : base(std::exchange(other.base, nullptr)), length(std::exchange(other.length, 0)),
+          file_bytes(std::exchange(other.file_bytes, 0)) {
+    }
+
+    MappedRegion &operator=(MappedRegion &&other) noexcept {
+        if (this != &other) {
+            if (base) ::munmap(base, length);
+            base = std::exchange(other.base, nullptr);
+            length = std::exchange(other.length, 0);
+            file_bytes = std::exchange(other.file_bytes, 0);
+        }
+        return *this;
+    }
+
+    std::byte *data() const { return base; }
+
+    // Mapped bytes, including the reserve.
+    size_t size() const { return length; }
+
+    size_t file_size() const { return file_bytes; }
+};
+
+#endif //LIST_IMAGE_H
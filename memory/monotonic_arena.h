@@ -0,0 +1,109 @@
+﻿#ifndef MONOTONIC_ARENA_H
+#define MONOTONIC_ARENA_H
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Blocks and bump cursor shared by every copy and rebind of one arena.
+template<size_t BlockBytes>
+struct MonotonicArenaState {
+    static constexpr std::align_val_t block_align{alignof(std::max_align_t)};
+
+    std::vector<std::byte *> blocks;
+    std::byte *cursor = nullptr;
+    std::byte *end = nullptr;
+    size_t live = 0;
+
+    MonotonicArenaState() = default;
+
+    MonotonicArenaState(const MonotonicArenaState &) = delete;
+
+    MonotonicArenaState &operator=(const MonotonicArenaState &) = delete;
+
+    ~MonotonicArenaState() { release(); }
+
+    void *bump(size_t bytes, size_t align) {
+        auto addr = reinterpret_cast<uintptr_t>(cursor);
+        auto aligned = (addr + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+        if (!cursor || aligned + bytes > reinterpret_cast<uintptr_t>(end)) {
+            size_t size = std::max(BlockBytes, bytes + align);
+            blocks.reserve(blocks.size() + 1);
+            blocks.push_back(static_cast<std::byte *>(::operator new(size, block_align)));
+            cursor = blocks.back();
+            end = cursor + size;
+            addr = reinterpret_cast<uintptr_t>(cursor);
+            aligned = (addr + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+        }
+        cursor = reinterpret_cast<std::byte *>(aligned + bytes);
+        return reinterpret_cast<void *>(aligned);
+    }
+
+    void release() noexcept {
+        for (std::byte *block: blocks) {
+            ::operator delete(block, block_align);
+        }
+        blocks.clear();
+        cursor = end = nullptr;
+        live = 0;
+    }
+};
+
+// Bump allocator: memory is handed out front to back from blocks of at least
+// BlockBytes and only returned to the system by release() or when the last
+// copy of the arena goes away. deallocate() just updates the live count.
+template<typename T, size_t BlockBytes = 64 * 1024>
+class MonotonicArena {
+    using State = MonotonicArenaState<BlockBytes>;
+
+    std::shared_ptr<State> state;
+
+    template<typename, size_t>
+    friend class MonotonicArena;
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    template<typename U>
+    struct rebind {
+        using other = MonotonicArena<U, BlockBytes>;
+    };
+
+    MonotonicArena() : state(std::make_shared<State>()) {
+    }
+
+    // Unlike NodePool, an arena does not care about object size, so rebound
+    // copies keep drawing from the same blocks.
+    template<typename U>
+    MonotonicArena(const MonotonicArena<U, BlockBytes> &other) : state(other.state) {
+    }
+
+    T *allocate(size_t n) {
+        static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned types are not supported");
+        void *p = state->bump(n * sizeof(T), alignof(T));
+        state->live += n;
+        return static_cast<T *>(p);
+    }
+
+    void deallocate(T *, size_t n) noexcept {
+        state->live -= n;
+    }
+
+    // Drops every block at once without running destructors.
+    void release() noexcept { state->release(); }
+
+    size_t live() const noexcept { return state->live; }
+
+    template<typename U>
+    bool operator==(const MonotonicArena<U, BlockBytes> &other) const noexcept {
+        return state == other.state;
+    }
+};
+
+#endif //MONOTONIC_ARENA_H
@@ -0,0 +1,185 @@
+﻿#ifndef NODE_BLOCKS_H
+#define NODE_BLOCKS_H
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Links that span more than this many bytes count as fragmented: the next
+// node is not in the same or an adjacent cache line pair.
+inline constexpr size_t compaction_near_bytes = 256;
+
+inline bool nodes_far_apart(const void *a, const void *b) {
+    uintptr_t x = reinterpret_cast<uintptr_t>(a);
+    uintptr_t y = reinterpret_cast<uintptr_t>(b);
+    return (x > y ? x - y : y - x) > compaction_near_bytes;
+}
+
+// Bookkeeping for the node arrays that a list's compact() allocates in one
+// piece. Nodes in a block are still destroyed one at a time; the array goes
+// back to the allocator together with its last node. split and splice move
+// nodes between lists, so block records are shared: each counts its live
+// nodes and the lists that refer to it.
+//
+// Also holds the automatic compaction trigger. A list that never compacts
+// pays one null pointer and one test per freed node.
+template<typename Node, typename NodeAlloc>
+class NodeBlocks {
+    using NodeTraits = std::allocator_traits<NodeAlloc>;
+
+    struct Block {
+        Node *nodes;
+        size_t capacity;
+        size_t live;
+        size_t refs;
+
+        bool owns(const Node *p) const {
+            return reinterpret_cast<uintptr_t>(p) - reinterpret_cast<uintptr_t>(nodes) < capacity * sizeof(Node);
+        }
+    };
+
+    struct State {
+        std::vector<Block *> blocks;
+        double threshold = 0;
+        size_t churn = 0;
+    };
+
+    State *state = nullptr;
+
+    State &get() {
+        if (!state) state = new State;
+        return *state;
+    }
+
+    static void drop(Block *block) {
+        if (--block->refs == 0) delete block;
+    }
+
+    // Records whose array is gone only wait for their last reference.
+    void prune() {
+        std::erase_if(state->blocks, [](Block *block) {
+            if (block->live) return false;
+            drop(block);
+            return true;
+        });
+    }
+
+public:
+    NodeBlocks() = default;
+
+    NodeBlocks(const NodeBlocks &) = delete;
+
+    NodeBlocks &operator=(const NodeBlocks &) = delete;
+
+    NodeBlocks(NodeBlocks &&other) noexcept : state(other.state) {
+        other.state = nullptr;
+    }
+
+    NodeBlocks &operator=(NodeBlocks &&other) noexcept {
+        if (this != &other) {
+            reset();
+            delete state;
+            state = other.state;
+            other.state = nullptr;
+        }
+        return *this;
+    }
+
+    ~NodeBlocks() {
+        reset();
+        delete state;
+    }
+
+    bool empty() const { return !state || state->blocks.empty(); }
+
+    // Uninitialized storage for n nodes, counted as n live ones.
+    Node *allocate(NodeAlloc &alloc, size_t n) {
+        State &s = get();
+        s.blocks.reserve(s.blocks.size() + 1);
+        Node *nodes = NodeTraits::allocate(alloc, n);
+        try {
+            s.blocks.push_back(new Block{nodes, n, n, 1});
+        } catch (...) {
+            NodeTraits::deallocate(alloc, nodes, n);
+            throw;
+        }
+        return nodes;
+    }
+
+    // Frees a block from allocate() whose nodes were never handed out.
+    void abandon(NodeAlloc &alloc, Node *nodes) {
+        for (Block *block: state->blocks) {
+            if (block->nodes == nodes) {
+                NodeTraits::deallocate(alloc, nodes, block->capacity);
+                block->live = 0;
+                block->capacity = 0;
+            }
+        }
+        prune();
+    }
+
+    // Accounts for a destroyed node. Returns false when the node is not in
+    // a block and has to be deallocated on its own.
+    bool release(NodeAlloc &alloc, Node *node) {
+        if (!state) return false;
+        for (Block *block: state->blocks) {
+            if (!block->owns(node)) continue;
+            if (--block->live == 0) {
+                NodeTraits::deallocate(alloc, block->nodes, block->capacity);
+                block->capacity = 0;
+                prune();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    // Gives a list split off from this one access to the same blocks.
+    void share(const NodeBlocks &other) {
+        if (other.empty()) return;
+        State &s = get();
+        s.blocks.reserve(s.blocks.size() + other.state->blocks.size());
+        for (Block *block: other.state->blocks) {
+            ++block->refs;
+            s.blocks.push_back(block);
+        }
+    }
+
+    // Takes over other's blocks along with its nodes.
+    void take(NodeBlocks &other) {
+        if (other.empty()) return;
+        State &s = get();
+        s.blocks.reserve(s.blocks.size() + other.state->blocks.size());
+        for (Block *block: other.state->blocks) {
+            if (std::find(s.blocks.begin(), s.blocks.end(), block) == s.blocks.end()) s.blocks.push_back(block);
+            else drop(block);
+        }
+        other.state->blocks.clear();
+    }
+
+    // Forgets every block; called once the list holds no nodes.
+    void reset() {
+        if (!state) return;
+        for (Block *block: state->blocks) drop(block);
+        state->blocks.clear();
+    }
+
+    void set_threshold(double fraction) {
+        if (fraction > 0 || state) get().threshold = fraction;
+    }
+
+    double threshold() const { return state ? state->threshold : 0; }
+
+    // Counts one allocated or freed node. True once the churn since the
+    // last check reaches the list size, which keeps the O(n) fragmentation
+    // check amortized O(1) per operation.
+    bool due(size_t count) {
+        if (!state || state->threshold <= 0) return false;
+        if (++state->churn < std::max(count, size_t{64})) return false;
+        state->churn = 0;
+        return true;
+    }
+};
+
+#endif //NODE_BLOCKS_H
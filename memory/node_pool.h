@@ -0,0 +1,155 @@
+﻿#ifndef NODE_POOL_H
+#define NODE_POOL_H
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// One slot size worth of blocks and free list, shared by every NodePool
+// copy and rebind that maps to that size.
+template<size_t BlockSize>
+struct NodePoolBucket {
+    size_t slot_size;
+    std::align_val_t slot_align;
+    std::vector<void *> blocks;
+    void *free = nullptr;
+    size_t used = BlockSize;
+    size_t live = 0;
+
+    // Free slots hold the free-list link in place, so every slot must be
+    // at least pointer sized.
+    static size_t size_for(size_t size, size_t align) {
+        return (std::max(size, sizeof(void *)) + align - 1) / align * align;
+    }
+
+    static std::align_val_t align_for(size_t align) {
+        return std::align_val_t{std::max(align, alignof(void *))};
+    }
+
+    NodePoolBucket(size_t size, size_t align) : slot_size(size_for(size, align)), slot_align(align_for(align)) {
+    }
+
+    NodePoolBucket(const NodePoolBucket &) = delete;
+
+    NodePoolBucket &operator=(const NodePoolBucket &) = delete;
+
+    ~NodePoolBucket() { release(); }
+
+    void *allocate() {
+        void *slot = free;
+        if (slot) {
+            free = *static_cast<void **>(slot);
+        } else {
+            if (used == BlockSize) {
+                blocks.reserve(blocks.size() + 1);
+                blocks.push_back(::operator new(BlockSize * slot_size, slot_align));
+                used = 0;
+            }
+            slot = static_cast<std::byte *>(blocks.back()) + used++ * slot_size;
+        }
+        ++live;
+        return slot;
+    }
+
+    void deallocate(void *slot) noexcept {
+        *static_cast<void **>(slot) = free;
+        free = slot;
+        --live;
+    }
+
+    void release() noexcept {
+        for (void *block: blocks) {
+            ::operator delete(block, slot_align);
+        }
+        blocks.clear();
+        free = nullptr;
+        used = BlockSize;
+        live = 0;
+    }
+};
+
+template<size_t BlockSize>
+struct NodePoolBuckets {
+    std::vector<std::unique_ptr<NodePoolBucket<BlockSize> > > sizes;
+
+    NodePoolBucket<BlockSize> *find(size_t size, size_t align) {
+        for (auto &bucket: sizes) {
+            if (bucket->slot_size == NodePoolBucket<BlockSize>::size_for(size, align) &&
+                bucket->slot_align == NodePoolBucket<BlockSize>::align_for(align)) {
+                return bucket.get();
+            }
+        }
+        sizes.push_back(std::make_unique<NodePoolBucket<BlockSize> >(size, align));
+        return sizes.back().get();
+    }
+};
+
+// Free-list allocator for node-based containers. Single-object requests are
+// carved out of blocks of BlockSize slots and recycled on deallocate; larger
+// requests go straight to operator new. Copies and rebinds of one pool share
+// its storage, with one bucket per slot size, so lists built from the same
+// pool can hand nodes to each other.
+template<typename T, size_t BlockSize = 256>
+class NodePool {
+    static_assert(BlockSize > 0, "BlockSize must be positive");
+
+    template<typename, size_t>
+    friend class NodePool;
+
+    using Bucket = NodePoolBucket<BlockSize>;
+    using Buckets = NodePoolBuckets<BlockSize>;
+
+    std::shared_ptr<Buckets> buckets;
+    Bucket *bucket;
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    template<typename U>
+    struct rebind {
+        using other = NodePool<U, BlockSize>;
+    };
+
+    NodePool()
+        : buckets(std::make_shared<Buckets>()), bucket(buckets->find(sizeof(T), alignof(T))) {
+    }
+
+    template<typename U>
+    NodePool(const NodePool<U, BlockSize> &other)
+        : buckets(other.buckets), bucket(buckets->find(sizeof(T), alignof(T))) {
+    }
+
+    T *allocate(size_t n) {
+        if (n != 1) {
+            return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t{alignof(T)}));
+        }
+        return static_cast<T *>(bucket->allocate());
+    }
+
+    void deallocate(T *p, size_t n) noexcept {
+        if (n != 1) {
+            ::operator delete(p, std::align_val_t{alignof(T)});
+            return;
+        }
+        bucket->deallocate(p);
+    }
+
+    // Drops every block of this type's bucket at once. Objects still living
+    // there are not destroyed, so callers must only use this once they are
+    // all dead or trivially destructible.
+    void release() noexcept { bucket->release(); }
+
+    size_t live() const noexcept { return bucket->live; }
+
+    template<typename U>
+    bool operator==(const NodePool<U, BlockSize> &other) const noexcept {
+        return buckets == other.buckets;
+    }
+};
+
+#endif //NODE_POOL_H